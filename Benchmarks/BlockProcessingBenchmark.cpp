@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    BlockProcessingBenchmark.cpp
+
+    Compares DelayEngine's block processing against the original per-sample
+    tick chain from processBlock, at several host block sizes.
+
+    Build (from the repo root):
+      g++ -O2 -std=c++17 -ISource Benchmarks/BlockProcessingBenchmark.cpp \
+          Source/DelayEngine.cpp Source/FeedbackFilters.cpp \
+          Source/Mu45FilterCalc/Mu45FilterCalc.cpp \
+          Source/StkLite-4.6.1/Stk.cpp Source/StkLite-4.6.1/Delay.cpp \
+          Source/StkLite-4.6.1/BiQuad.cpp -o BlockProcessingBenchmark
+
+  ==============================================================================
+*/
+
+#include "DelayEngine.h"
+#include "FeedbackGain.h"
+#include "Mu45FilterCalc/Mu45FilterCalc.h"
+#include "StkLite-4.6.1/BiQuad.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static const float fs = 48000;
+static const int numSeconds = 10;
+static const int numRuns = 5; // best of
+static const int blockSizes[] = { 32, 128, 512, 2048 };
+
+static unsigned long delaySamps(float ms) {
+    return std::ceil(ms*(fs/1000.0));
+}
+
+/* The processBlock loop as it was before DelayEngine, one channel at a time */
+struct PerSampleChannel
+{
+    stk::Delay delay;
+    stk::BiQuad highPass;
+    stk::BiQuad lowPass;
+    float feedbackGain, wetGain, dryGain;
+
+    void process(float* data, int numSamples) {
+        for (int samp = 0; samp < numSamples; samp++) {
+            float feedbackDelayInput = delay.nextOut();
+            feedbackDelayInput *= feedbackGain;
+            feedbackDelayInput = lowPass.tick(feedbackDelayInput);
+            feedbackDelayInput = highPass.tick(feedbackDelayInput);
+            delay.tick(data[samp] + feedbackDelayInput);
+
+            data[samp] = dryGain*data[samp] + feedbackGain*wetGain*delay.nextOut();
+        }
+    }
+};
+
+int main() {
+    const float delayMs[2] = { 150, 375 };
+    const float feedbackGain = determineFeedbackGain(80);
+    float coeffsHP[5], coeffsLP[5];
+    Mu45FilterCalc::calcCoeffsHPF(coeffsHP, LOW_CUT_DEFAULT_FC, LOW_CUT_Q, fs);
+    Mu45FilterCalc::calcCoeffsLPF(coeffsLP, HIGH_CUT_DEFAULT_FC, HIGH_CUT_Q, fs);
+
+    const int totalSamples = numSeconds*fs;
+    std::vector<float> input(totalSamples);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+    for (float& x : input)
+        x = dist(rng);
+
+    std::printf("%10s %16s %16s %10s %12s\n", "block", "per-sample ns", "block ns", "speedup", "max diff");
+
+    for (int blockSize : blockSizes) {
+        /* Per-sample reference */
+        PerSampleChannel ref[2];
+        for (int ch = 0; ch < 2; ch++) {
+            ref[ch].delay.setMaximumDelay(delaySamps(DELAY_LENGTH_MS_MAX));
+            ref[ch].delay.setDelay(delaySamps(delayMs[ch]));
+            ref[ch].highPass.setCoefficients(coeffsHP[0], coeffsHP[1], coeffsHP[2], coeffsHP[3], coeffsHP[4]);
+            ref[ch].lowPass.setCoefficients(coeffsLP[0], coeffsLP[1], coeffsLP[2], coeffsLP[3], coeffsLP[4]);
+            ref[ch].feedbackGain = feedbackGain;
+            ref[ch].wetGain = 0.5;
+            ref[ch].dryGain = 0.5;
+        }
+
+        /* Block engine */
+        DelayEngine engine;
+        engine.prepare(fs, blockSize);
+        for (int ch = 0; ch < 2; ch++) {
+            engine.setDelaySamps(ch, delaySamps(delayMs[ch]));
+            engine.setHighPassCoeffs(ch, coeffsHP);
+            engine.setLowPassCoeffs(ch, coeffsLP);
+            engine.setFeedbackGain(ch, feedbackGain);
+            engine.setWetDryGains(ch, 0.5, 0.5);
+        }
+
+        std::vector<float> refOut[2], blockOut[2];
+        double refTime = 1e30, blockTime = 1e30;
+
+        // state carries over between runs, only the last run's output is compared
+        for (int run = 0; run < numRuns; run++) {
+            refOut[0] = refOut[1] = blockOut[0] = blockOut[1] = input;
+
+            auto t0 = std::chrono::steady_clock::now();
+            for (int start = 0; start + blockSize <= totalSamples; start += blockSize)
+                for (int ch = 0; ch < 2; ch++)
+                    ref[ch].process(refOut[ch].data() + start, blockSize);
+            auto t1 = std::chrono::steady_clock::now();
+            for (int start = 0; start + blockSize <= totalSamples; start += blockSize) {
+                float* channels[2] = { blockOut[0].data() + start, blockOut[1].data() + start };
+                engine.process(channels, blockSize);
+            }
+            auto t2 = std::chrono::steady_clock::now();
+
+            refTime = std::min(refTime, std::chrono::duration<double, std::nano>(t1 - t0).count());
+            blockTime = std::min(blockTime, std::chrono::duration<double, std::nano>(t2 - t1).count());
+        }
+
+        float maxDiff = 0;
+        for (int ch = 0; ch < 2; ch++)
+            for (int i = 0; i < totalSamples; i++)
+                maxDiff = std::max(maxDiff, std::abs(refOut[ch][i] - blockOut[ch][i]));
+
+        double numProcessed = 2.0*(totalSamples/blockSize)*blockSize;
+        double refNs = refTime/numProcessed;
+        double blockNs = blockTime/numProcessed;
+        std::printf("%10d %16.2f %16.2f %9.2fx %12.3g\n", blockSize, refNs, blockNs, refNs/blockNs, maxDiff);
+    }
+
+    return 0;
+}
@@ -0,0 +1,105 @@
+/*
+  ==============================================================================
+
+    StateBenchmark.cpp
+
+    Cost of saving and loading the plugin state through PluginState, with
+    the plugin's own parameter IDs: a save, a load with the entries in the
+    same order as the parameters, and a load with them reversed (the worst
+    case for the lookup by ID). Also checks that everything round-trips.
+
+    Build (from the repo root):
+      g++ -O2 -std=c++17 -ISource Benchmarks/StateBenchmark.cpp \
+          Source/PluginState.cpp -o StateBenchmark
+
+  ==============================================================================
+*/
+
+#include "PluginState.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+static const int iterations = 1 << 20;
+static const int numRuns = 5; // best of
+
+// getParameters() order in ColemanJP03DelayAudioProcessor
+static const char* const ids[] = {
+    "leftDelayMs", "rightDelayMs", "leftFeedback", "rightFeedback", "leftDryWet", "rightDryWet",
+    "leftHighPassCutFc", "rightHighPassCutFc", "leftLowPassCutFc", "rightLowPassCutFc", "matchLR"
+};
+static const int numParams = sizeof(ids)/sizeof(ids[0]);
+
+static volatile float sink; // keeps the results alive
+
+/* Runs op() iterations times, numRuns times, and returns the best ns per call */
+template <class Op>
+static double time(Op op) {
+    double best = 1e30;
+    for (int r = 0; r < numRuns; r++) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++)
+            op(i);
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count()/iterations);
+    }
+    return best;
+}
+
+int main() {
+    float values[numParams];
+    for (int i = 0; i < numParams; i++)
+        values[i] = 10.0f*i + 0.25f;
+
+    const int size = PluginState::sizeFor(numParams);
+    std::vector<unsigned char> chunk(size), reversedChunk(size);
+    PluginState::write(chunk.data(), ids, values, numParams);
+
+    const char* reversedIds[numParams];
+    float reversedValues[numParams];
+    for (int i = 0; i < numParams; i++) {
+        reversedIds[i] = ids[numParams - 1 - i];
+        reversedValues[i] = values[numParams - 1 - i];
+    }
+    PluginState::write(reversedChunk.data(), reversedIds, reversedValues, numParams);
+
+    /* Round trip, both orders */
+    bool ok = true;
+    for (auto* data : { &chunk, &reversedChunk }) {
+        float loaded[numParams];
+        bool found[numParams];
+        ok = ok && PluginState::read(data->data(), size, ids, loaded, found, numParams);
+        for (int i = 0; i < numParams; i++)
+            ok = ok && found[i] && loaded[i] == values[i];
+    }
+    // a truncated chunk is rejected
+    {
+        float loaded[numParams];
+        bool found[numParams];
+        ok = ok && ! PluginState::read(chunk.data(), size - 1, ids, loaded, found, numParams);
+    }
+
+    double saveNs = time([&](int i) {
+        values[0] = (float) i;
+        PluginState::write(chunk.data(), ids, values, numParams);
+        sink = sink + chunk[PluginState::headerSize + PluginState::idLength];
+    });
+
+    float loaded[numParams];
+    bool found[numParams];
+    double loadNs = time([&](int) {
+        PluginState::read(chunk.data(), size, ids, loaded, found, numParams);
+        sink = sink + loaded[numParams - 1];
+    });
+    double reversedLoadNs = time([&](int) {
+        PluginState::read(reversedChunk.data(), size, ids, loaded, found, numParams);
+        sink = sink + loaded[numParams - 1];
+    });
+
+    std::printf("%d parameters, %d bytes, round trip %s\n", numParams, size, ok ? "ok" : "FAILED");
+    std::printf("%-24s %10.1f ns\n", "save", saveNs);
+    std::printf("%-24s %10.1f ns\n", "load", loadNs);
+    std::printf("%-24s %10.1f ns\n", "load (reversed order)", reversedLoadNs);
+    return ok ? 0 : 1;
+}
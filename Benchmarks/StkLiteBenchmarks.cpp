@@ -0,0 +1,299 @@
+/*
+  ==============================================================================
+
+    StkLiteBenchmarks.cpp
+
+    Throughput baselines for the StkLite kernels: every class is timed
+    through its per-sample tick(StkFloat) and its StkFrames block tick, at
+    several buffer sizes (and delay lengths for the delay lines). A swept
+    delay is timed both ways too: stk::DelayL moved every sample, and
+    stk::Delay's interpolated block read.
+
+    Usage:
+      StkLiteBenchmarks [--json file] [--filter text]
+
+      --json file    also write the results as JSON ("-" for stdout), one
+                     entry per kernel/mode/buffer size/delay length
+      --filter text  only run benchmarks whose name contains text
+
+    Build (from the repo root, add -D_STK_FLOAT32_ to match the plugin):
+      g++ -O2 -std=c++17 -ISource Benchmarks/StkLiteBenchmarks.cpp \
+          Source/StkLite-4.6.1/[A-Z]*.cpp -o StkLiteBenchmarks
+
+  ==============================================================================
+*/
+
+#include "StkLite-4.6.1/BiQuad.h"
+#include "StkLite-4.6.1/Delay.h"
+#include "StkLite-4.6.1/DelayA.h"
+#include "StkLite-4.6.1/DelayL.h"
+#include "StkLite-4.6.1/Fir.h"
+#include "StkLite-4.6.1/FormSwep.h"
+#include "StkLite-4.6.1/Iir.h"
+#include "StkLite-4.6.1/OnePole.h"
+#include "StkLite-4.6.1/PoleZero.h"
+#include "StkLite-4.6.1/TapDelay.h"
+#include "StkLite-4.6.1/TwoPole.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <random>
+#include <string>
+#include <vector>
+
+using stk::StkFloat;
+using stk::StkFrames;
+
+static const double fs = 48000;
+static const long samplesPerRun = 1 << 20;
+static const int numRuns = 5; // best of
+static const int bufferSizes[] = { 64, 512, 4096 };
+static const unsigned long delayLengths[] = { 64, 4800, 96000 }; // 1.3 ms, 100 ms, 2 s
+static const int numTaps = 4;
+static const int firLength = 32;
+static const double modDepthMs = 4; // for the modulated delays
+
+static volatile StkFloat sink; // keeps the outputs alive
+
+struct Result
+{
+    std::string name;
+    std::string kernel;
+    std::string mode; // "tick" (per sample) or "frames" (StkFrames block)
+    int bufferSize;
+    long delay;       // < 0 for the filters
+    long iterations;  // buffers processed per run
+    double nsPerSample;
+};
+
+struct Suite
+{
+    std::string filter;
+    FILE* table = stdout;
+    std::vector<Result> results;
+
+    /* Runs process(input, output) over samplesPerRun samples, numRuns times, and keeps the best */
+    template <class Process>
+    void run(const std::string& kernel, const std::string& mode, int bufferSize, long delay,
+             int outChannels, Process process) {
+        std::string name = kernel + "/" + mode + "/buffer:" + std::to_string(bufferSize);
+        if (delay >= 0)
+            name += "/delay:" + std::to_string(delay);
+        if (name.find(filter) == std::string::npos)
+            return;
+
+        // the same noise buffer is fed in every time, so nothing but the kernel is timed
+        StkFrames input(bufferSize, 1);
+        StkFrames output(bufferSize, outChannels);
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<StkFloat> dist(-0.5, 0.5);
+        for (unsigned int i = 0; i < input.frames(); i++)
+            input[i] = dist(rng);
+
+        long iterations = samplesPerRun/bufferSize;
+        double best = 1e30;
+        for (int r = 0; r < numRuns; r++) {
+            auto start = std::chrono::steady_clock::now();
+            for (long i = 0; i < iterations; i++)
+                process(input, output);
+            auto end = std::chrono::steady_clock::now();
+
+            best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+            sink = sink + output[0];
+        }
+
+        Result result = { name, kernel, mode, bufferSize, delay, iterations, best/(iterations*bufferSize) };
+        std::fprintf(table, "%-46s %10.2f %14.1f\n", name.c_str(), result.nsPerSample, 1e3/result.nsPerSample);
+        std::fflush(table);
+        results.push_back(result);
+    }
+
+    /* Both modes for a single-output kernel */
+    template <class Kernel>
+    void runKernel(const std::string& kernel, Kernel& k, int bufferSize, long delay = -1) {
+        run(kernel, "tick", bufferSize, delay, 1, [&k](StkFrames& in, StkFrames& out) {
+            for (unsigned int i = 0; i < in.frames(); i++)
+                out[i] = k.tick(in[i]);
+        });
+        run(kernel, "frames", bufferSize, delay, 1, [&k](StkFrames& in, StkFrames& out) {
+            k.tick(in, out);
+        });
+    }
+
+    /* A delay swept up to modDepthMs longer over every buffer: stk::DelayL moved and
+       ticked every sample, against stk::Delay's block read with per-sample extra delays
+       (only for buffers it can read before writing, at least two shorter than the delay) */
+    void runModulated(int bufferSize, unsigned long delay) {
+        const StkFloat depth = modDepthMs*fs/1000;
+        std::vector<StkFloat> extra(bufferSize);
+        for (int i = 0; i < bufferSize; i++)
+            extra[i] = depth*(0.5 - 0.5*std::cos(stk::TWO_PI*i/bufferSize));
+
+        stk::DelayL delayL(delay, delay + (unsigned long) depth + 1);
+        run("ModulatedDelayL", "tick", bufferSize, delay, 1, [&](StkFrames& in, StkFrames& out) {
+            for (unsigned int i = 0; i < in.frames(); i++) {
+                delayL.setDelay(delay + extra[i]);
+                out[i] = delayL.tick(in[i]);
+            }
+        });
+
+        if (delay < (unsigned long) bufferSize + 2)
+            return;
+        stk::Delay delayLine(delay, delay + (unsigned long) depth + 3);
+        run("ModulatedDelay", "frames", bufferSize, delay, 1, [&](StkFrames& in, StkFrames& out) {
+            delayLine.readBlock(&out[0], in.frames(), extra.data());
+            delayLine.writeBlock(&in[0], in.frames());
+        });
+    }
+
+    /* TapDelay writes one output channel per tap */
+    void runTapDelay(stk::TapDelay& k, int bufferSize, long delay) {
+        StkFrames taps(1, numTaps);
+        run("TapDelay", "tick", bufferSize, delay, numTaps, [&k, &taps](StkFrames& in, StkFrames& out) {
+            for (unsigned int i = 0; i < in.frames(); i++) {
+                k.tick(in[i], taps);
+                for (int t = 0; t < numTaps; t++)
+                    out(i, t) = taps[t];
+            }
+        });
+        run("TapDelay", "frames", bufferSize, delay, numTaps, [&k](StkFrames& in, StkFrames& out) {
+            k.tick(in, out);
+        });
+    }
+};
+
+static std::string jsonString(const std::string& s) {
+    std::string quoted = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\')
+            quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+static bool writeJson(const char* path, const std::vector<Result>& results) {
+    FILE* out = std::strcmp(path, "-") == 0 ? stdout : std::fopen(path, "w");
+    if (out == nullptr)
+        return false;
+
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    std::fprintf(out, "{\n  \"context\": {\n");
+    std::fprintf(out, "    \"date\": \"%s\",\n", date);
+    std::fprintf(out, "    \"stk_float_bits\": %d,\n", (int) (8*sizeof(StkFloat)));
+    std::fprintf(out, "    \"sample_rate\": %.0f,\n", fs);
+    std::fprintf(out, "    \"samples_per_run\": %ld,\n", samplesPerRun);
+    std::fprintf(out, "    \"runs\": %d\n", numRuns);
+    std::fprintf(out, "  },\n  \"benchmarks\": [\n");
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        std::fprintf(out, "    {\"name\": %s, \"kernel\": %s, \"mode\": %s, \"buffer_size\": %d, ",
+                     jsonString(r.name).c_str(), jsonString(r.kernel).c_str(), jsonString(r.mode).c_str(),
+                     r.bufferSize);
+        if (r.delay >= 0)
+            std::fprintf(out, "\"delay\": %ld, ", r.delay);
+        std::fprintf(out, "\"iterations\": %ld, \"ns_per_sample\": %.4f, \"samples_per_second\": %.0f}%s\n",
+                     r.iterations, r.nsPerSample, 1e9/r.nsPerSample, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(out, "  ]\n}\n");
+
+    bool ok = ! std::ferror(out);
+    if (out != stdout)
+        ok = std::fclose(out) == 0 && ok;
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    Suite suite;
+    const char* jsonPath = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && std::strcmp(argv[i], "--json") == 0)
+            jsonPath = argv[++i];
+        else if (i + 1 < argc && std::strcmp(argv[i], "--filter") == 0)
+            suite.filter = argv[++i];
+        else {
+            std::fprintf(stderr, "usage: StkLiteBenchmarks [--json file] [--filter text]\n");
+            return 1;
+        }
+    }
+
+    stk::Stk::setSampleRate(fs);
+
+    // with JSON on stdout the table goes to stderr, so the JSON can be piped as it is
+    suite.table = jsonPath != nullptr && std::strcmp(jsonPath, "-") == 0 ? stderr : stdout;
+    std::fprintf(suite.table, "%-46s %10s %14s\n", "benchmark", "ns/sample", "Msamples/s");
+
+    /* Delay lines */
+    for (unsigned long delay : delayLengths) {
+        for (int bufferSize : bufferSizes) {
+            stk::Delay delayLine(delay, delay);
+            suite.runKernel("Delay", delayLine, bufferSize, delay);
+
+            // half a sample extra, so the interpolation actually does something
+            stk::DelayL delayL(delay + 0.5, delay + 1);
+            suite.runKernel("DelayL", delayL, bufferSize, delay);
+
+            stk::DelayA delayA(delay + 0.5, delay + 1);
+            suite.runKernel("DelayA", delayA, bufferSize, delay);
+
+            std::vector<unsigned long> taps;
+            for (int t = 1; t <= numTaps; t++)
+                taps.push_back(delay*t/numTaps);
+            stk::TapDelay tapDelay(taps, delay);
+            suite.runTapDelay(tapDelay, bufferSize, delay);
+
+            suite.runModulated(bufferSize, delay);
+        }
+    }
+
+    /* Filters */
+    for (int bufferSize : bufferSizes) {
+        stk::BiQuad biQuad;
+        biQuad.setResonance(1000, 0.99, true);
+        suite.runKernel("BiQuad", biQuad, bufferSize);
+
+        // windowed-sinc low pass at fs/4
+        std::vector<StkFloat> firCoeffs(firLength);
+        for (int i = 0; i < firLength; i++) {
+            double x = i - (firLength - 1)/2.0;
+            double sinc = x == 0 ? 0.5 : std::sin(0.5*stk::PI*x)/(stk::PI*x);
+            firCoeffs[i] = sinc*(0.54 - 0.46*std::cos(stk::TWO_PI*i/(firLength - 1)));
+        }
+        stk::Fir fir(firCoeffs);
+        suite.runKernel("Fir", fir, bufferSize);
+
+        // two resonators (pole radius 0.95), multiplied out into one 4th-order direct form
+        std::vector<StkFloat> b = { 1, 0, -2, 0, 1 };
+        std::vector<StkFloat> a = { 1, -3.5, 4.865, -3.15875, 0.81450625 };
+        stk::Iir iir(b, a);
+        iir.setGain(0.01);
+        suite.runKernel("Iir", iir, bufferSize);
+
+        stk::OnePole onePole(0.9);
+        suite.runKernel("OnePole", onePole, bufferSize);
+
+        stk::TwoPole twoPole;
+        twoPole.setResonance(1000, 0.99, true);
+        suite.runKernel("TwoPole", twoPole, bufferSize);
+
+        stk::PoleZero poleZero;
+        poleZero.setAllpass(0.5);
+        suite.runKernel("PoleZero", poleZero, bufferSize);
+
+        stk::FormSwep formSwep;
+        formSwep.setResonance(1000, 0.99);
+        suite.runKernel("FormSwep", formSwep, bufferSize);
+    }
+
+    if (jsonPath != nullptr && ! writeJson(jsonPath, suite.results)) {
+        std::fprintf(stderr, "can't write %s\n", jsonPath);
+        return 1;
+    }
+    return 0;
+}
@@ -38,6 +38,54 @@
 
 #define MATCH_LR_DEFAULT        false
 
+#define MULTITAP_DEFAULT        false
+#define MULTITAP_NUM_TAPS_MAX   16
+#define MULTITAP_NUM_TAPS_DEFAULT 4
+#define MULTITAP_SPACING_MS_DEFAULT 125 // ms, tap n defaults to n times this
+#define MULTITAP_GAIN_MIN       0 // Percent
+#define MULTITAP_GAIN_MAX       100
+#define MULTITAP_GAIN_DEFAULT   50
+#define MULTITAP_PAN_MIN        -100 // -100 = left, 100 = right
+#define MULTITAP_PAN_MAX        100
+#define MULTITAP_PAN_DEFAULT    0
+
+#define CROSS_FEED_MIN          0 // Percent of each channel's feedback sent to the other channel
+#define CROSS_FEED_MAX          100
+#define CROSS_FEED_DEFAULT      0
+#define PING_PONG_DEFAULT       false
+
+#define MOD_RATE_HZ_MIN         0.05 // Hz, delay time modulation
+#define MOD_RATE_HZ_MAX         10
+#define MOD_RATE_HZ_DEFAULT     0.5
+#define MOD_RATE_HZ_SKEW        0.3
+#define MOD_DEPTH_MS_MIN        0 // ms the delay times swing up by, 0 = off
+#define MOD_DEPTH_MS_MAX        10
+#define MOD_DEPTH_MS_DEFAULT    0
+#define MOD_DEPTH_MS_INTERVAL   0.01
+#define MOD_STEREO_PHASE        0.25 // cycles the right channel's LFO runs ahead of the left
+
+#define SATURATION_DEFAULT      false // soft clipping in the feedback loops
+#define SATURATION_DRIVE_DB_MIN 0 // dB into the curve, which lowers its ceiling by as much
+#define SATURATION_DRIVE_DB_MAX 24
+#define SATURATION_DRIVE_DB_DEFAULT 6
+
+#define TEMPO_SYNC_DEFAULT      false
+#define TEMPO_BPM_DEFAULT       120 // until the host reports a tempo
+
+#define PARAM_SMOOTHING_MS      20 // ms, ramp length for gain and filter changes
+#define DELAY_CROSSFADE_MS      20 // ms, crossfade between old and new delay times
+#define DELAY_CROSSFADE_LINEAR_MS 1 // ms, delay time steps up to this long crossfade linearly (e.g. tempo ramps)
+
+#define SILENCE_THRESHOLD_DB    -120 // dB, below this the engine counts as silent and can sleep
+#define SAMPLE_RATE_MAX         192000 // Hz, delay lines are reserved for this rate up front
+#define OVERSAMPLING_DEFAULT    0      // index of Off, 2x, 4x; the engine never runs above SAMPLE_RATE_MAX
+#define LATENCY_CHECK_HZ        10     // how often the message thread looks for a latency change to report
+#define ENGINE_CHUNK_SIZE_MAX   2048   // samples, longer host blocks are processed in chunks
+#define LEVEL_FIFO_SIZE         128    // blocks of meter levels queued for the editor
+#define WAVEFORM_NUM_BINS       1024   // min/max bins over the longest delay, for the waveform view
+#define WAVEFORM_BIN_MS         ((double) DELAY_LENGTH_MS_MAX/WAVEFORM_NUM_BINS)
+#define WAVEFORM_FIFO_SIZE      1024   // waveform bins queued for the editor
+
 #define FILTER_SUFFIX_HZ        " Hz"
 #define FILTER_SUFFIX_KHZ       " kHz"
 #define DELAY_SUFFIX            " ms"
@@ -50,3 +98,11 @@
 
 #define CONTAINER_WIDTH         24*UNIT_LENGTH_X
 #define CONTAINER_HEIGHT        23*UNIT_LENGTH_Y
+
+#define METER_PANEL_WIDTH       7*UNIT_LENGTH_X // input, feedback and output meters, right of the controls
+#define METER_DB_MIN            -60 // dB, bottom of the meter scale
+#define METER_DB_MAX            6
+#define METER_RELEASE_DB_PER_S  24  // how fast the bars fall back
+#define EDITOR_REFRESH_HZ       60  // how often the editor picks up parameter changes and redraws the meters
+
+#define WAVEFORM_HEIGHT         5*UNIT_LENGTH_Y // delay line view, below the controls and meters
@@ -0,0 +1,733 @@
+/*
+  ==============================================================================
+
+    DelayEngine.cpp
+
+  ==============================================================================
+*/
+
+#include "DelayEngine.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(DELAY_NO_SIMD) // scalar loops only
+#elif defined(_STK_FLOAT32_) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+ #include <emmintrin.h>
+ #define DELAY_ENGINE_SSE 1
+#elif defined(_STK_FLOAT32_) && defined(__ARM_NEON)
+ #include <arm_neon.h>
+ #define DELAY_ENGINE_NEON 1
+#endif
+
+DelayEngine::DelayEngine() : mode(stereo), multiTapDelay(ENGINE_CHUNK_SIZE_MAX),
+                             saturators { Saturator(ENGINE_CHUNK_SIZE_MAX), Saturator(ENGINE_CHUNK_SIZE_MAX) }, smoothingSamps(0),
+                             lineSamps(maxDelaySamps(SAMPLE_RATE_MAX) + 1), linearCrossfadeSamps(0), snapParams(true), maxChunkSize(0),
+                             oversamplers { Oversampler(ENGINE_CHUNK_SIZE_MAX), Oversampler(ENGINE_CHUNK_SIZE_MAX) },
+                             silenceThreshold(std::pow(10.0f, SILENCE_THRESHOLD_DB/20.0f)), quietSamps(0), sleeping(false),
+                             metering(false), levels(), waveformBinSamps(1), waveformBinPos(0) {
+    waveformBin.clear();
+    saturationDrive.setTarget(1, 0);
+    for (int ch = 0; ch < numChannels; ch++) {
+        dryGains[ch].setTarget(1, 0);
+        oversampledData[ch].resize(ENGINE_CHUNK_SIZE_MAX);
+    }
+
+    // Reserve everything for the worst case now, so prepare() only has to
+    // resize within what is already there (StkFrames never shrinks its memory).
+    reserve(SAMPLE_RATE_MAX);
+    resizeScratch(ENGINE_CHUNK_SIZE_MAX);
+}
+
+unsigned long DelayEngine::maxDelaySamps(float sampleRate) {
+    // room for the longest delay at full modulation depth, plus the samples the
+    // modulated reads interpolate from
+    return std::ceil((DELAY_LENGTH_MS_MAX + MOD_DEPTH_MS_MAX)*(sampleRate/1000.0)) + Interpolator::points;
+}
+
+void DelayEngine::reserve(float sampleRate) {
+    for (int ch = 0; ch < numChannels; ch++)
+        delays[ch].setMaximumDelay(maxDelaySamps(sampleRate));
+    multiTapDelay.setMaximumDelay(maxDelaySamps(sampleRate));
+}
+
+void DelayEngine::resizeScratch(int chunkSize) {
+    maxChunkSize = chunkSize;
+    for (int ch = 0; ch < numChannels; ch++) {
+        delayOutFrames[ch].resize(maxChunkSize + 1, 1);
+        feedbackFrames[ch].resize(maxChunkSize, 1);
+        feedbackGainFrames[ch].resize(maxChunkSize, 1);
+    }
+    wetGainFrames.resize(maxChunkSize, 1);
+    dryGainFrames.resize(maxChunkSize, 1);
+    crossFeedFrames.resize(maxChunkSize, 1);
+    pingPongFrames.resize(maxChunkSize, 1);
+    for (int ch = 0; ch < numChannels; ch++)
+        modFrames[ch].resize(maxChunkSize + 1, 1);
+    modDepthFrames.resize(maxChunkSize + 1, 1);
+    saturationFrames.resize(maxChunkSize, 1);
+    saturationDriveFrames.resize(maxChunkSize, 1);
+    saturatedFrames.resize(maxChunkSize, 1);
+}
+
+void DelayEngine::prepare(float sampleRate, int maxBlockSize, int oversampling) {
+    // from here on everything is at the oversampled rate, which the memory reserved
+    // for SAMPLE_RATE_MAX covers
+    while (oversampling > 1 && sampleRate*oversampling > SAMPLE_RATE_MAX)
+        oversampling /= 2;
+    for (int ch = 0; ch < numChannels; ch++)
+        oversamplers[ch].setFactor(oversampling);
+    sampleRate *= oversampling;
+    maxBlockSize *= oversampling;
+
+    // only allocates for rates above SAMPLE_RATE_MAX
+    reserve(sampleRate);
+
+    unsigned long crossfadeSamps = std::round(DELAY_CROSSFADE_MS*(sampleRate/1000.0));
+    // only the part of the lines that can be read at this rate needs clearing
+    lineSamps = maxDelaySamps(sampleRate) + 1;
+    for (int ch = 0; ch < numChannels; ch++) {
+        delays[ch].clearRecent(lineSamps);
+        // the old and new read positions are usually far apart, so treat them as uncorrelated
+        // (setDelaySamps picks the linear curve for small steps)
+        delays[ch].setCrossfade(crossfadeSamps, stk::Delay::EQUAL_POWER);
+    }
+    multiTapDelay.clear(lineSamps);
+    multiTapDelay.setCrossfade(crossfadeSamps); // always equal power
+    linearCrossfadeSamps = std::round(DELAY_CROSSFADE_LINEAR_MS*(sampleRate/1000.0));
+    feedbackFilters.clear();
+    for (Saturator& saturator : saturators)
+        saturator.reset();
+    lfos[0].setPhase(0);
+    lfos[1].setPhase(MOD_STEREO_PHASE);
+
+    smoothingSamps = (int) std::round(PARAM_SMOOTHING_MS*(sampleRate/1000.0));
+    snapParams = true;
+    quietSamps = 0;
+    sleeping = false;
+
+    waveformBinSamps = std::max((int) std::round(WAVEFORM_BIN_MS*(sampleRate/1000.0)), 1);
+    waveformBin.clear();
+    waveformBinPos = 0;
+
+    // blocks longer than the scratch buffers are split into chunks by process()
+    resizeScratch(std::min(std::max(maxBlockSize, 1), ENGINE_CHUNK_SIZE_MAX));
+}
+
+void DelayEngine::setDelaySamps(int channel, unsigned long samps) {
+    unsigned long current = delays[channel].getDelay();
+    unsigned long step = samps > current ? samps - current : current - samps;
+    delays[channel].setCrossfadeCurve(step <= linearCrossfadeSamps ? stk::Delay::LINEAR : stk::Delay::EQUAL_POWER);
+    delays[channel].setDelay(samps);
+    if (snapParams)
+        delays[channel].endCrossfade();
+}
+
+void DelayEngine::setFeedbackGain(int channel, float gain) {
+    feedbackGains[channel].setTarget(gain, snapParams ? 0 : smoothingSamps);
+}
+
+void DelayEngine::setWetDryGains(int channel, float wetGain, float dryGain) {
+    wetGains[channel].setTarget(wetGain, snapParams ? 0 : smoothingSamps);
+    dryGains[channel].setTarget(dryGain, snapParams ? 0 : smoothingSamps);
+}
+
+void DelayEngine::setHighPassCoeffs(int channel, const float* coeffs) {
+    feedbackFilters.setHighPassCoeffs(channel, coeffs, snapParams ? 0 : smoothingSamps);
+}
+
+void DelayEngine::setLowPassCoeffs(int channel, const float* coeffs) {
+    feedbackFilters.setLowPassCoeffs(channel, coeffs, snapParams ? 0 : smoothingSamps);
+}
+
+void DelayEngine::setCrossFeed(float amount) {
+    crossFeed.setTarget(amount, snapParams ? 0 : smoothingSamps);
+}
+
+void DelayEngine::setPingPong(bool enabled) {
+    pingPong.setTarget(enabled ? 1 : 0, snapParams ? 0 : smoothingSamps);
+}
+
+void DelayEngine::setModDepth(float depthSamps) {
+    modDepth.setTarget(depthSamps, snapParams ? 0 : smoothingSamps);
+}
+
+void DelayEngine::setModRate(float cyclesPerSample) {
+    for (Lfo& lfo : lfos)
+        lfo.setRate(cyclesPerSample);
+}
+
+void DelayEngine::setModWaveform(Lfo::Waveform waveform) {
+    for (Lfo& lfo : lfos)
+        lfo.setWaveform(waveform);
+}
+
+void DelayEngine::setSaturation(bool enabled) {
+    // don't carry the last input over from when it was last on
+    if (enabled && saturation.current == 0 && ! saturation.isRamping())
+        for (Saturator& saturator : saturators)
+            saturator.reset();
+    saturation.setTarget(enabled ? 1 : 0, snapParams ? 0 : smoothingSamps);
+}
+
+void DelayEngine::setSaturationDrive(float drive) {
+    // nothing hears it while the saturation is off, so there is nothing to smooth
+    const bool off = saturation.current == 0 && ! saturation.isRamping();
+    saturationDrive.setTarget(drive, snapParams || off ? 0 : smoothingSamps);
+}
+
+void DelayEngine::setMode(Mode newMode) {
+    if (newMode == mode)
+        return;
+    mode = newMode;
+
+    // the lines of the mode that was off haven't been written since it was last on
+    if (mode == multiTap)
+        multiTapDelay.clear(lineSamps);
+    else
+        for (int ch = 0; ch < numChannels; ch++)
+            delays[ch].clearRecent(lineSamps);
+    feedbackFilters.clear();
+}
+
+void DelayEngine::setTap(int tap, unsigned long delaySamps, float gain, float pan, bool feedback) {
+    multiTapDelay.setTap(tap, delaySamps, gain, pan, feedback, snapParams ? 0 : smoothingSamps);
+}
+
+// Adds numSamples to a peak and a sum of squares. The partial results are kept in
+// 2 x 4 lanes, which the compiler isn't allowed to do for float sums by itself.
+#if DELAY_ENGINE_SSE
+static void accumulateLevels(const float* data, int numSamples, float& peak, float& sumSquares) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 peaks[2] = { _mm_setzero_ps(), _mm_setzero_ps() }, sums[2] = { _mm_setzero_ps(), _mm_setzero_ps() };
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        for (int k = 0; k < 2; k++) {
+            __m128 x = _mm_loadu_ps(data + i + 4*k);
+            peaks[k] = _mm_max_ps(peaks[k], _mm_and_ps(x, absMask));
+            sums[k] = _mm_add_ps(sums[k], _mm_mul_ps(x, x));
+        }
+    }
+
+    alignas(16) float p[4], s[4];
+    _mm_store_ps(p, _mm_max_ps(peaks[0], peaks[1]));
+    _mm_store_ps(s, _mm_add_ps(sums[0], sums[1]));
+    for (; i < numSamples; i++) {
+        p[0] = std::max(p[0], std::abs(data[i]));
+        s[0] += data[i]*data[i];
+    }
+    peak = std::max({ peak, p[0], p[1], p[2], p[3] });
+    sumSquares += (s[0] + s[1]) + (s[2] + s[3]);
+}
+
+// Raises peak to the largest magnitude in numSamples
+static void accumulatePeak(const float* data, int numSamples, float& peak) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 peaks = _mm_set1_ps(peak);
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4)
+        peaks = _mm_max_ps(peaks, _mm_and_ps(_mm_loadu_ps(data + i), absMask));
+
+    alignas(16) float p[4];
+    _mm_store_ps(p, peaks);
+    for (; i < numSamples; i++)
+        p[0] = std::max(p[0], std::abs(data[i]));
+    peak = std::max({ p[0], p[1], p[2], p[3] });
+}
+
+// Widens [lo, hi] to cover numSamples
+static void accumulateRange(const float* data, int numSamples, float& lo, float& hi) {
+    __m128 los = _mm_set1_ps(lo), his = _mm_set1_ps(hi);
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        __m128 x = _mm_loadu_ps(data + i);
+        los = _mm_min_ps(los, x);
+        his = _mm_max_ps(his, x);
+    }
+
+    alignas(16) float l[4], h[4];
+    _mm_store_ps(l, los);
+    _mm_store_ps(h, his);
+    for (; i < numSamples; i++) {
+        l[0] = std::min(l[0], data[i]);
+        h[0] = std::max(h[0], data[i]);
+    }
+    lo = std::min({ l[0], l[1], l[2], l[3] });
+    hi = std::max({ h[0], h[1], h[2], h[3] });
+}
+#elif DELAY_ENGINE_NEON
+static void accumulateLevels(const float* data, int numSamples, float& peak, float& sumSquares) {
+    float32x4_t peaks[2] = { vdupq_n_f32(0), vdupq_n_f32(0) }, sums[2] = { vdupq_n_f32(0), vdupq_n_f32(0) };
+    int i = 0;
+    for (; i + 8 <= numSamples; i += 8) {
+        for (int k = 0; k < 2; k++) {
+            float32x4_t x = vld1q_f32(data + i + 4*k);
+            peaks[k] = vmaxq_f32(peaks[k], vabsq_f32(x));
+            sums[k] = vmlaq_f32(sums[k], x, x);
+        }
+    }
+
+    float p[4], s[4];
+    vst1q_f32(p, vmaxq_f32(peaks[0], peaks[1]));
+    vst1q_f32(s, vaddq_f32(sums[0], sums[1]));
+    for (; i < numSamples; i++) {
+        p[0] = std::max(p[0], std::abs(data[i]));
+        s[0] += data[i]*data[i];
+    }
+    peak = std::max({ peak, p[0], p[1], p[2], p[3] });
+    sumSquares += (s[0] + s[1]) + (s[2] + s[3]);
+}
+
+// Raises peak to the largest magnitude in numSamples
+static void accumulatePeak(const float* data, int numSamples, float& peak) {
+    float32x4_t peaks = vdupq_n_f32(peak);
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4)
+        peaks = vmaxq_f32(peaks, vabsq_f32(vld1q_f32(data + i)));
+
+    float p[4];
+    vst1q_f32(p, peaks);
+    for (; i < numSamples; i++)
+        p[0] = std::max(p[0], std::abs(data[i]));
+    peak = std::max({ p[0], p[1], p[2], p[3] });
+}
+
+// Widens [lo, hi] to cover numSamples
+static void accumulateRange(const float* data, int numSamples, float& lo, float& hi) {
+    float32x4_t los = vdupq_n_f32(lo), his = vdupq_n_f32(hi);
+    int i = 0;
+    for (; i + 4 <= numSamples; i += 4) {
+        float32x4_t x = vld1q_f32(data + i);
+        los = vminq_f32(los, x);
+        his = vmaxq_f32(his, x);
+    }
+
+    float l[4], h[4];
+    vst1q_f32(l, los);
+    vst1q_f32(h, his);
+    for (; i < numSamples; i++) {
+        l[0] = std::min(l[0], data[i]);
+        h[0] = std::max(h[0], data[i]);
+    }
+    lo = std::min({ l[0], l[1], l[2], l[3] });
+    hi = std::max({ h[0], h[1], h[2], h[3] });
+}
+#else
+template <typename Sample>
+static void accumulateLevels(const Sample* data, int numSamples, float& peak, float& sumSquares) {
+    Sample p = 0, s = 0;
+    for (int i = 0; i < numSamples; i++) {
+        p = std::max(p, std::abs(data[i]));
+        s += data[i]*data[i];
+    }
+    peak = std::max(peak, (float) p);
+    sumSquares += (float) s;
+}
+
+// Raises peak to the largest magnitude in numSamples
+template <typename Sample>
+static void accumulatePeak(const Sample* data, int numSamples, float& peak) {
+    for (int i = 0; i < numSamples; i++)
+        peak = std::max(peak, (float) std::abs(data[i]));
+}
+
+// Widens [lo, hi] to cover numSamples
+template <typename Sample>
+static void accumulateRange(const Sample* data, int numSamples, float& lo, float& hi) {
+    for (int i = 0; i < numSamples; i++) {
+        lo = std::min(lo, (float) data[i]);
+        hi = std::max(hi, (float) data[i]);
+    }
+}
+#endif
+
+void DelayEngine::process(float* const* channelData, int numSamples) {
+    // asleep, or ready to sleep, with a silent block of input
+    if (sleeping || quietSamps > readReach()) {
+        float inputPeak = 0;
+        for (int ch = 0; ch < numChannels; ch++)
+            accumulatePeak(channelData[ch], numSamples, inputPeak);
+        if (inputPeak < silenceThreshold) {
+            if (! sleeping)
+                sleep();
+            for (int ch = 0; ch < numChannels; ch++)
+                std::fill(channelData[ch], channelData[ch] + numSamples, 0.0f);
+            if (metering)
+                levels.numSamples += numSamples*getOversampling();
+            return;
+        }
+        sleeping = false;
+    }
+
+    snapParams = false;
+    const int factor = getOversampling();
+    if (factor == 1) {
+        processAtRate(channelData, numSamples);
+        return;
+    }
+
+    // in pieces that fit the oversampled scratch buffers
+    const int maxPiece = ENGINE_CHUNK_SIZE_MAX/factor;
+    float* pieceData[numChannels];
+    for (int ch = 0; ch < numChannels; ch++)
+        pieceData[ch] = oversampledData[ch].data();
+    for (int start = 0; start < numSamples;) {
+        int pieceSize = std::min(maxPiece, numSamples - start);
+        for (int ch = 0; ch < numChannels; ch++)
+            oversamplers[ch].upsample(channelData[ch] + start, pieceData[ch], pieceSize);
+        processAtRate(pieceData, pieceSize*factor);
+        for (int ch = 0; ch < numChannels; ch++)
+            oversamplers[ch].downsample(pieceData[ch], channelData[ch] + start, pieceSize);
+        start += pieceSize;
+    }
+}
+
+// the chunk loop, at the oversampled rate
+void DelayEngine::processAtRate(float* const* channelData, int numSamples) {
+    if (metering)
+        levels.numSamples += numSamples;
+
+    for (int start = 0; start < numSamples;) {
+        // every sample in a chunk must be read before its feedback is written back,
+        // so a chunk can't reach the write position of either channel, or of an old
+        // read position that is still fading out: at most delay - 1 samples, or
+        // less while modulated, since the interpolation reads Interpolator::newer samples newer
+        int chunkLimit = std::max(maxChunkSize, 1);
+        if (mode == multiTap) {
+            unsigned long delaySamps = multiTapDelay.getMinimumReadDelay();
+            chunkLimit = (int) std::min<unsigned long>(chunkLimit, delaySamps > 1 ? delaySamps - 1 : 1);
+        }
+        else {
+            const unsigned long reach = isModulated() ? 1 + Interpolator::newer : 1;
+            for (int ch = 0; ch < numChannels; ch++) {
+                unsigned long delaySamps = delays[ch].getMinimumReadDelay();
+                chunkLimit = (int) std::min<unsigned long>(chunkLimit, delaySamps > reach ? delaySamps - reach : 1);
+            }
+        }
+
+        float* chunkData[numChannels];
+        for (int ch = 0; ch < numChannels; ch++)
+            chunkData[ch] = channelData[ch] + start;
+        int chunkSize = std::min(chunkLimit, numSamples - start);
+        if (mode == multiTap)
+            processMultiTapChunk(chunkData, chunkSize);
+        else
+            processChunk(chunkData, chunkSize);
+        start += chunkSize;
+    }
+}
+
+void DelayEngine::processChunk(float* const* channelData, int numSamples) {
+    const stk::StkFloat* delayOut[numChannels];
+    stk::StkFloat* feedback[numChannels];
+
+    /* Read the delay outputs for this chunk, plus one more for the wet tap
+       (the output uses the delay's next output after the current sample is written).
+       While modulated, each read is depth*LFO samples further back, interpolated. */
+    const bool modulated = isModulated();
+    const stk::StkFloat* depth = &modDepthFrames[0];
+    if (modulated) {
+        modDepth.fill(&modDepthFrames[0], numSamples);
+        modDepthFrames[numSamples] = modDepth.current; // the ramp's next value, for the wet tap
+    }
+    for (int ch = 0; ch < numChannels; ch++) {
+        if (modulated) {
+            stk::StkFloat* extraDelay = &modFrames[ch][0];
+            lfos[ch].fill(extraDelay, numSamples + 1);
+            for (int i = 0; i <= numSamples; i++)
+                extraDelay[i] *= depth[i];
+            delays[ch].readBlock<Interpolator>(&delayOutFrames[ch][0], numSamples + 1, extraDelay);
+        }
+        else {
+            delays[ch].readBlock(&delayOutFrames[ch][0], numSamples + 1);
+        }
+        lfos[ch].advance(numSamples); // runs at zero depth too, so turning it up doesn't restart the cycle
+        delayOut[ch] = &delayOutFrames[ch][0];
+        feedback[ch] = &feedbackFrames[ch][0];
+    }
+
+    /* Feedback gains and the cross-feed matrix, both channels in one pass. Each line's
+       output is scaled by its own feedback gain, and then the crossFeed share of it goes
+       to the other line instead: [l', r'] = [[1 - c, c], [c, 1 - c]] [l, r]. With c = 0
+       this is exactly the two separate loops. Ping-pong only bounces with full cross-feed,
+       so while it is on, c is at least its amount whatever the cross-feed is set to. */
+    const bool pingPongOn = pingPong.isRamping() || pingPong.current != 0;
+    const bool gainsRamping = feedbackGains[0].isRamping() || feedbackGains[1].isRamping() || crossFeed.isRamping()
+                              || pingPong.isRamping();
+    stk::StkFloat* pingPongAmount = &pingPongFrames[0];
+    if (pingPongOn)
+        pingPong.fill(pingPongAmount, numSamples);
+    if (gainsRamping) {
+        stk::StkFloat* feedbackGain[numChannels] = { &feedbackGainFrames[0][0], &feedbackGainFrames[1][0] };
+        stk::StkFloat* cross = &crossFeedFrames[0];
+        for (int ch = 0; ch < numChannels; ch++)
+            feedbackGains[ch].fill(feedbackGain[ch], numSamples);
+        crossFeed.fill(cross, numSamples);
+        if (pingPongOn)
+            for (int i = 0; i < numSamples; i++)
+                cross[i] = std::max(cross[i], pingPongAmount[i]);
+        for (int i = 0; i < numSamples; i++) {
+            const float l = feedbackGain[0][i]*delayOut[0][i], r = feedbackGain[1][i]*delayOut[1][i];
+            feedback[0][i] = l + cross[i]*(r - l);
+            feedback[1][i] = r + cross[i]*(l - r);
+        }
+    }
+    else {
+        const float leftGain = feedbackGains[0].current, rightGain = feedbackGains[1].current;
+        const float cross = std::max(crossFeed.current, pingPong.current);
+        for (int i = 0; i < numSamples; i++) {
+            const float l = leftGain*delayOut[0][i], r = rightGain*delayOut[1][i];
+            feedback[0][i] = l + cross*(r - l);
+            feedback[1][i] = r + cross*(l - r);
+        }
+    }
+
+    saturate(feedback, numChannels, numSamples);
+
+    /* Feedback filters, both channels at once */
+    feedbackFilters.process(feedback[0], feedback[1], numSamples);
+
+    if (metering) {
+        for (int ch = 0; ch < numChannels; ch++) {
+            accumulateLevels(channelData[ch], numSamples, levels.peak[LevelFrame::input][ch],
+                             levels.sumSquares[LevelFrame::input][ch]);
+            accumulateLevels(feedback[ch], numSamples, levels.peak[LevelFrame::feedback][ch],
+                             levels.sumSquares[LevelFrame::feedback][ch]);
+        }
+    }
+
+    /* Write input + feedback into the delay lines. For ping-pong the input goes into the
+       left line only, summed to mono, so the full cross-feed bounces it from side to side. */
+    const float* left = channelData[0];
+    const float* right = channelData[1];
+    if (pingPongOn) {
+        for (int i = 0; i < numSamples; i++) {
+            feedback[0][i] += left[i] + pingPongAmount[i]*0.5f*(right[i] - left[i]);
+            feedback[1][i] += right[i] - pingPongAmount[i]*right[i];
+        }
+    }
+    else {
+        for (int i = 0; i < numSamples; i++) {
+            feedback[0][i] += left[i];
+            feedback[1][i] += right[i];
+        }
+    }
+    for (int ch = 0; ch < numChannels; ch++)
+        delays[ch].writeBlock(feedback[ch], numSamples);
+
+    /* Mix */
+    for (int ch = 0; ch < numChannels; ch++) {
+        float* data = channelData[ch];
+
+        if (gainsRamping || wetGains[ch].isRamping() || dryGains[ch].isRamping()) {
+            const stk::StkFloat* feedbackGain = &feedbackGainFrames[ch][0];
+            stk::StkFloat* wetGain = &wetGainFrames[0];
+            stk::StkFloat* dryGain = &dryGainFrames[0];
+            wetGains[ch].fill(wetGain, numSamples);
+            dryGains[ch].fill(dryGain, numSamples);
+            if (gainsRamping)
+                for (int i = 0; i < numSamples; i++)
+                    wetGain[i] *= feedbackGain[i];
+            else
+                for (int i = 0; i < numSamples; i++)
+                    wetGain[i] *= feedbackGains[ch].current;
+
+            for (int i = 0; i < numSamples; i++)
+                data[i] = dryGain[i]*data[i] + wetGain[i]*delayOut[ch][i + 1];
+        }
+        else {
+            const float wetGain = feedbackGains[ch].current*wetGains[ch].current;
+            const float dryGain = dryGains[ch].current;
+            for (int i = 0; i < numSamples; i++)
+                data[i] = dryGain*data[i] + wetGain*delayOut[ch][i + 1];
+        }
+
+        if (metering)
+            accumulateLevels(data, numSamples, levels.peak[LevelFrame::output][ch],
+                             levels.sumSquares[LevelFrame::output][ch]);
+    }
+
+    trackQuiet(feedback, numChannels, numSamples);
+    if (metering)
+        addWaveform(feedback, numSamples);
+}
+
+void DelayEngine::processMultiTapChunk(float* const* channelData, int numSamples) {
+    stk::StkFloat* wet[numChannels] = { &delayOutFrames[0][0], &delayOutFrames[1][0] };
+    stk::StkFloat* feedback = &feedbackFrames[0][0];
+    stk::StkFloat* silence = &feedbackFrames[1][0]; // for the right filter lanes, which are unused
+
+    /* Every tap at once: the panned wet sums and the feedback send */
+    multiTapDelay.read(wet[0], wet[1], feedback, numSamples);
+
+    if (feedbackGains[0].isRamping()) {
+        stk::StkFloat* feedbackGain = &feedbackGainFrames[0][0];
+        feedbackGains[0].fill(feedbackGain, numSamples);
+        for (int i = 0; i < numSamples; i++)
+            feedback[i] *= feedbackGain[i];
+    }
+    else {
+        const float feedbackGain = feedbackGains[0].current;
+        for (int i = 0; i < numSamples; i++)
+            feedback[i] *= feedbackGain;
+    }
+
+    saturate(&feedback, 1, numSamples);
+
+    /* Feedback filters, the left channel's */
+    std::fill(silence, silence + numSamples, 0.0f);
+    feedbackFilters.process(feedback, silence, numSamples);
+
+    if (metering) {
+        for (int ch = 0; ch < numChannels; ch++) {
+            accumulateLevels(channelData[ch], numSamples, levels.peak[LevelFrame::input][ch],
+                             levels.sumSquares[LevelFrame::input][ch]);
+            accumulateLevels(feedback, numSamples, levels.peak[LevelFrame::feedback][ch],
+                             levels.sumSquares[LevelFrame::feedback][ch]);
+        }
+    }
+
+    /* Write the mono input + feedback into the line */
+    const float* left = channelData[0];
+    const float* right = channelData[1];
+    for (int i = 0; i < numSamples; i++)
+        feedback[i] += 0.5f*(left[i] + right[i]);
+    multiTapDelay.write(feedback, numSamples);
+    trackQuiet(&feedback, 1, numSamples);
+
+    /* Mix */
+    for (int ch = 0; ch < numChannels; ch++) {
+        float* data = channelData[ch];
+        if (wetGains[ch].isRamping() || dryGains[ch].isRamping()) {
+            stk::StkFloat* wetGain = &wetGainFrames[0];
+            stk::StkFloat* dryGain = &dryGainFrames[0];
+            wetGains[ch].fill(wetGain, numSamples);
+            dryGains[ch].fill(dryGain, numSamples);
+            for (int i = 0; i < numSamples; i++)
+                data[i] = dryGain[i]*data[i] + wetGain[i]*wet[ch][i];
+        }
+        else {
+            const float wetGain = wetGains[ch].current;
+            const float dryGain = dryGains[ch].current;
+            for (int i = 0; i < numSamples; i++)
+                data[i] = dryGain*data[i] + wetGain*wet[ch][i];
+        }
+
+        if (metering)
+            accumulateLevels(data, numSamples, levels.peak[LevelFrame::output][ch],
+                             levels.sumSquares[LevelFrame::output][ch]);
+    }
+
+    if (metering) {
+        stk::StkFloat* written[numChannels] = { feedback, feedback };
+        addWaveform(written, numSamples);
+    }
+}
+
+// counts how long what goes into the delay lines has stayed below the silence threshold
+void DelayEngine::trackQuiet(stk::StkFloat* const* written, int numLoops, int numSamples) {
+    float peak = 0;
+    for (int ch = 0; ch < numLoops; ch++)
+        accumulatePeak(written[ch], numSamples, peak);
+    quietSamps = peak < silenceThreshold ? quietSamps + numSamples : 0;
+}
+
+// how far back the current reads go: anything written longer ago than this can't be heard
+unsigned long DelayEngine::readReach() const {
+    if (mode == multiTap)
+        return multiTapDelay.getMaximumReadDelay();
+
+    unsigned long reach = std::max(delays[0].getMaximumReadDelay(), delays[1].getMaximumReadDelay());
+    if (isModulated())
+        reach += std::ceil(std::max(modDepth.current, modDepth.target)) + Interpolator::points;
+    return reach;
+}
+
+// Puts the engine to sleep. Everything it still holds is below the silence threshold, so
+// clearing it now (while there's no DSP to do) means nothing stale can be read on waking,
+// however long the lines stood still and whatever delay times are set meanwhile.
+void DelayEngine::sleep() {
+    sleeping = true;
+    snapParams = true;
+    if (mode == multiTap)
+        multiTapDelay.clear(lineSamps);
+    else
+        for (int ch = 0; ch < numChannels; ch++)
+            delays[ch].clearRecent(lineSamps);
+    feedbackFilters.clear();
+    for (int ch = 0; ch < numChannels; ch++) {
+        saturators[ch].reset();
+        oversamplers[ch].reset();
+    }
+}
+
+double DelayEngine::getTailSamples() const {
+    // the loudest loop sets the decay; the cross-feed matrix only shares its output out
+    float gain = feedbackGains[0].target;
+    unsigned long loopSamps;
+    if (mode == multiTap) {
+        // every tap sent back adds to the one loop; the longest tap bounds the trip round it
+        gain *= multiTapDelay.getFeedbackGain();
+        loopSamps = multiTapDelay.getMaximumReadDelay();
+    }
+    else {
+        gain = std::max(gain, feedbackGains[1].target);
+        loopSamps = std::max(delays[0].getDelay(), delays[1].getDelay()) + (unsigned long) std::ceil(modDepth.target);
+    }
+
+    if (gain >= 1)
+        return std::numeric_limits<double>::infinity();
+    // the first repeat, then however many trips around the loop it takes to fall below the threshold
+    double repeats = gain > 0 ? std::ceil(SILENCE_THRESHOLD_DB/(20*std::log10(gain))) : 0;
+    return loopSamps*(1 + repeats);
+}
+
+// saturates the feedback of the first numLoops loops in place, crossfading while it is switched on or off
+void DelayEngine::saturate(stk::StkFloat* const* feedback, int numLoops, int numSamples) {
+    if (saturation.current == 0 && ! saturation.isRamping())
+        return;
+
+    const stk::StkFloat* drive = nullptr;
+    if (saturationDrive.isRamping()) {
+        drive = &saturationDriveFrames[0];
+        saturationDrive.fill(&saturationDriveFrames[0], numSamples);
+    }
+
+    if (! saturation.isRamping()) {
+        for (int ch = 0; ch < numLoops; ch++) {
+            if (drive)
+                saturators[ch].process(feedback[ch], feedback[ch], numSamples, drive);
+            else
+                saturators[ch].process(feedback[ch], feedback[ch], numSamples, saturationDrive.current);
+        }
+        return;
+    }
+
+    stk::StkFloat* amount = &saturationFrames[0];
+    stk::StkFloat* saturated = &saturatedFrames[0];
+    saturation.fill(amount, numSamples);
+    for (int ch = 0; ch < numLoops; ch++) {
+        if (drive)
+            saturators[ch].process(feedback[ch], saturated, numSamples, drive);
+        else
+            saturators[ch].process(feedback[ch], saturated, numSamples, saturationDrive.current);
+        for (int i = 0; i < numSamples; i++)
+            feedback[ch][i] += amount[i]*(saturated[i] - feedback[ch][i]);
+    }
+}
+
+// adds what was just written into the delay lines to the waveform bins, queueing every bin that fills up
+void DelayEngine::addWaveform(stk::StkFloat* const* written, int numSamples) {
+    for (int start = 0; start < numSamples;) {
+        int n = std::min(numSamples - start, waveformBinSamps - waveformBinPos);
+        for (int ch = 0; ch < numChannels; ch++)
+            accumulateRange(written[ch] + start, n, waveformBin.min[ch], waveformBin.max[ch]);
+        waveformBinPos += n;
+        start += n;
+
+        if (waveformBinPos == waveformBinSamps) {
+            waveformFifo.push(waveformBin); // dropped if the queue is full
+            waveformBin.clear();
+            waveformBinPos = 0;
+        }
+    }
+}
@@ -0,0 +1,281 @@
+/*
+  ==============================================================================
+
+    DelayEngine.h
+
+    Stereo feedback delay DSP, kept free of JUCE so it can be run and
+    benchmarked outside of the plugin.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "StkLite-4.6.1/Delay.h"
+#include "FeedbackFilters.h"
+#include "FeedbackGain.h"
+#include "MultiTapDelay.h"
+#include "LinearRamp.h"
+#include "Lfo.h"
+#include "Oversampler.h"
+#include "Saturator.h"
+#include "SpscFifo.h"
+#include "Defines.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+/* Each channel runs: delay out -> feedback gain -> saturation -> low pass -> high pass -> back
+   into the delay, with the output mixed from the dry input and the delayed signal. The
+   saturation (see Saturator) is optional, and crossfaded in and out when it is switched.
+
+   Because the delay time is never shorter than DELAY_LENGTH_MS_MIN, a whole chunk of
+   feedback can be read out of the delay line before any of it is written back. That lets
+   every stage run over a full buffer at a time instead of one sample through the whole
+   chain. Chunks are capped at (delay - 1) samples so a host block that is longer than
+   the delay is still handled correctly.
+
+   Both channels go through each stage together so the four feedback filters can run
+   as one packed kernel (see FeedbackFilters), and the feedback gains and the 2x2
+   cross-feed matrix are applied to both channels in the same loop. Cross-feed sends part
+   of each line's feedback into the other line; with ping-pong, the input is summed to
+   mono into the left line only, and the cross-feed goes to full (whatever it is set to)
+   to bounce it from side to side.
+
+   Parameter changes are smoothed inside the chunk loop: gains ramp linearly over
+   PARAM_SMOOTHING_MS, filter coefficients are interpolated over the same time, and a
+   delay time change crossfades from the old read position to the new one over
+   DELAY_CROSSFADE_MS (done by stk::Delay). None of it needs more than adds and
+   multiplies per sample. Jumps are crossfaded with equal power, but small steps
+   (up to DELAY_CROSSFADE_LINEAR_MS, like the ones a tempo ramp makes in sync mode)
+   crossfade linearly, since both read positions hear nearly the same signal and an
+   equal-power fade would bump the level by up to 3 dB.
+
+   In stereo mode the delay times can be modulated by an LFO per channel (for chorus and
+   tape wow), which lengthens each one by up to the modulation depth. The modulated reads
+   are interpolated a chunk at a time by stk::Delay (with the Interpolator kernel), from
+   the LFO and depth values for the whole chunk, so modulation costs a few extra loops per
+   chunk rather than a per-sample delay change. The interpolation reads Interpolator::newer
+   samples newer than the plain reads, so chunks are that much shorter while it is on.
+
+   In multi-tap mode the two channels are summed to mono into one shared line with up to
+   MULTITAP_NUM_TAPS_MAX taps (see MultiTapDelay). The taps chosen for feedback go through
+   the left channel's feedback gain and filters and back into the line, and each output
+   channel gets its dry input plus the panned sum of the taps, at its own wet gain. The
+   right channel's delay time, feedback and filters are unused.
+
+   Optionally, the whole engine runs at 2x or 4x the host rate (see Oversampler): each
+   piece of a host block is upsampled, put through the chunk loop above, and downsampled
+   again, so anything nonlinear in the loop aliases less and modulated reads sound cleaner.
+   The dry signal goes through the same filters as the wet one, which keeps the two in
+   phase and makes the added latency exact. All the setters then take samples and rates
+   at the oversampled rate.
+
+   Once nothing louder than SILENCE_THRESHOLD_DB has gone into the delay lines for longer
+   than the longest delay being read, nothing that loud can come out of them again. The
+   engine keeps that count as it writes each chunk, so it costs a peak scan of what is
+   written rather than a pass over the lines. When the count is high enough and a whole
+   block of input is below the threshold too, process() goes to sleep: it clears the lines
+   and filters once, then outputs silence without running any DSP until the input comes
+   back. Parameter changes while asleep are applied without smoothing. */
+
+/* Peak and sum of squares at the three metering points, over one or more blocks */
+struct LevelFrame
+{
+    enum Point { input, feedback, output, numPoints };
+    static constexpr int numChannels = 2;
+
+    float peak[numPoints][numChannels];
+    float sumSquares[numPoints][numChannels];
+    int numSamples;
+
+    void clear() { *this = LevelFrame(); }
+
+    // folds another frame into this one, e.g. all the blocks since the last GUI update
+    void add(const LevelFrame& other) {
+        for (int p = 0; p < numPoints; p++) {
+            for (int ch = 0; ch < numChannels; ch++) {
+                peak[p][ch] = std::max(peak[p][ch], other.peak[p][ch]);
+                sumSquares[p][ch] += other.sumSquares[p][ch];
+            }
+        }
+        numSamples += other.numSamples;
+    }
+
+    float rms(Point p, int ch) const { return numSamples > 0 ? std::sqrt(sumSquares[p][ch]/numSamples) : 0; }
+};
+
+/* Range of the signal written into each delay line over WAVEFORM_BIN_MS.
+   WAVEFORM_NUM_BINS of them span the longest delay. */
+struct WaveformBin
+{
+    static constexpr int numChannels = 2;
+
+    float min[numChannels];
+    float max[numChannels];
+
+    void clear() {
+        for (int ch = 0; ch < numChannels; ch++) {
+            min[ch] = std::numeric_limits<float>::infinity();
+            max[ch] = -std::numeric_limits<float>::infinity();
+        }
+    }
+
+    // widens this bin to cover another one, e.g. two neighbours merged into a coarser bin
+    void add(const WaveformBin& other) {
+        for (int ch = 0; ch < numChannels; ch++) {
+            min[ch] = std::min(min[ch], other.min[ch]);
+            max[ch] = std::max(max[ch], other.max[ch]);
+        }
+    }
+};
+
+class DelayEngine
+{
+public:
+    static constexpr int numChannels = 2;
+
+    enum Mode { stereo, multiTap };
+
+    // fractional-delay kernel for the modulated reads. Third-order Lagrange is as cheap as
+    // Hermite and more accurate; see Benchmarks/InterpolationBenchmark for the others
+    typedef stk::Lagrange<3> Interpolator;
+
+    DelayEngine();
+
+    // Clears the state and sets up for a new rate, call from prepareToPlay.
+    // Memory for rates up to SAMPLE_RATE_MAX is reserved by the constructor,
+    // so this does not allocate unless sampleRate is higher than that.
+    // The parameters set before the next process() call are applied without smoothing.
+    // oversampling is 1, 2 or 4, lowered while it would take the rate above SAMPLE_RATE_MAX.
+    void prepare(float sampleRate, int maxBlockSize, int oversampling = 1);
+
+    // the factor prepare() settled on; the setters below work at sampleRate times this
+    int getOversampling() const { return oversamplers[0].getFactor(); }
+    // what the oversampling filters delay the output by, in samples at the host rate
+    int getLatencySamples() const { return oversamplers[0].getLatency(); }
+
+    // How long the output can keep going after the input stops, from the current delay
+    // times and feedback: until the repeats have died down to SILENCE_THRESHOLD_DB.
+    // In samples at the oversampled rate; infinite while the feedback doesn't decay
+    double getTailSamples() const;
+
+    // true while process() is skipping the DSP
+    bool isSleeping() const { return sleeping; }
+
+    /* Parameter setters, normally called once per block. Changes are smoothed. */
+    void setDelaySamps(int channel, unsigned long samps);
+    void setFeedbackGain(int channel, float gain);
+    void setWetDryGains(int channel, float wetGain, float dryGain);
+    // coeffs = [b0, b1, b2, a1, a2] as produced by Mu45FilterCalc
+    void setHighPassCoeffs(int channel, const float* coeffs);
+    void setLowPassCoeffs(int channel, const float* coeffs);
+    // stereo mode only: amount = 0 keeps the two loops apart, 1 sends each one into the other
+    void setCrossFeed(float amount);
+    // stereo mode only: mono input into the left line, bounced by full cross-feed while on
+    void setPingPong(bool enabled);
+    // stereo mode only: each delay time swings from its set value up to depthSamps longer
+    // (0 = off), the right channel's MOD_STEREO_PHASE ahead of the left. The depth is
+    // smoothed; a waveform change takes effect at once
+    void setModDepth(float depthSamps);
+    void setModRate(float cyclesPerSample);
+    void setModWaveform(Lfo::Waveform waveform);
+    // soft clipping of the feedback, before the filters. drive >= 1 is the gain into the
+    // curve, which also lowers the ceiling to 1/drive. Both are smoothed
+    void setSaturation(bool enabled);
+    void setSaturationDrive(float drive);
+
+    /* Switching modes clears the delay lines and filters the new mode uses, so it is not smoothed */
+    void setMode(Mode newMode);
+    // multi-tap mode only, see MultiTapDelay::setTap
+    void setTap(int tap, unsigned long delaySamps, float gain, float pan, bool feedback);
+
+    // processes numSamples of each channel in place
+    void process(float* const* channelData, int numSamples);
+
+    /* Level metering of the input, the filtered feedback and the output, and waveform
+       bins of what goes into the delay lines. Off by default; while on, every process()
+       call adds its levels to getLevels() until resetLevels(), and queues each waveform
+       bin as it completes. */
+    void setMetering(bool enabled) {
+        if (enabled && ! metering) {
+            // don't report what was left from the last time it was on
+            levels.clear();
+            waveformBin.clear();
+            waveformBinPos = 0;
+        }
+        metering = enabled;
+    }
+    const LevelFrame& getLevels() const { return levels; }
+    void resetLevels() { levels.clear(); }
+
+    // Waveform bins, oldest first. These two may be called from one other thread
+    // (e.g. the GUI) while process() runs; bins are dropped while the queue is full.
+    bool popWaveformBin(WaveformBin& bin) { return waveformFifo.pop(bin); }
+    void clearWaveformBins() { waveformFifo.clear(); }
+
+private:
+    bool isModulated() const { return modDepth.current != 0 || modDepth.isRamping(); }
+    void processAtRate(float* const* channelData, int numSamples);
+    void processChunk(float* const* channelData, int numSamples);
+    void processMultiTapChunk(float* const* channelData, int numSamples);
+    void saturate(stk::StkFloat* const* feedback, int numLoops, int numSamples);
+    void addWaveform(stk::StkFloat* const* written, int numSamples);
+    void trackQuiet(stk::StkFloat* const* written, int numLoops, int numSamples);
+    unsigned long readReach() const;
+    void sleep();
+    void reserve(float sampleRate);
+    void resizeScratch(int chunkSize);
+    static unsigned long maxDelaySamps(float sampleRate);
+
+    Mode mode;
+    stk::Delay delays[numChannels];
+    MultiTapDelay multiTapDelay;
+    FeedbackFilters feedbackFilters;
+
+    LinearRamp feedbackGains[numChannels];
+    LinearRamp wetGains[numChannels];
+    LinearRamp dryGains[numChannels];
+    LinearRamp crossFeed;
+    LinearRamp pingPong; // 0 = stereo input, 1 = mono input into the left line
+    Lfo lfos[numChannels];
+    LinearRamp modDepth; // samples
+    Saturator saturators[numChannels];
+    LinearRamp saturation; // 0 = off, 1 = on
+    LinearRamp saturationDrive;
+    int smoothingSamps;
+    unsigned long lineSamps; // how much of the delay lines can be read at the current rate
+    unsigned long linearCrossfadeSamps; // delay steps up to this long crossfade linearly
+    bool snapParams; // true until the first block after prepare()
+
+    /* Scratch buffers, reserved by the constructor so neither prepare() nor process() allocates */
+    stk::StkFrames delayOutFrames[numChannels]; // upcoming delay outputs for one chunk (+1 for the wet tap), or the tap sums
+    stk::StkFrames feedbackFrames[numChannels]; // feedback path, filtered in place
+    stk::StkFrames feedbackGainFrames[numChannels]; // per-sample gains while ramping
+    stk::StkFrames wetGainFrames;
+    stk::StkFrames dryGainFrames;
+    stk::StkFrames crossFeedFrames;
+    stk::StkFrames pingPongFrames;
+    stk::StkFrames modFrames[numChannels]; // extra delay of each read in the chunk (+1 for the wet tap)
+    stk::StkFrames modDepthFrames;
+    stk::StkFrames saturationFrames;
+    stk::StkFrames saturationDriveFrames;
+    stk::StkFrames saturatedFrames; // one loop's saturated feedback, while crossfading
+    int maxChunkSize;
+
+    Oversampler oversamplers[numChannels];
+    std::vector<float> oversampledData[numChannels]; // one piece of a block at the oversampled rate
+
+    float silenceThreshold; // linear
+    unsigned long quietSamps; // since anything at or above the threshold was written into the lines
+    bool sleeping;
+
+    bool metering;
+    LevelFrame levels;
+
+    int waveformBinSamps;
+    int waveformBinPos; // samples in waveformBin so far
+    WaveformBin waveformBin;
+    SpscFifo<WaveformBin, WAVEFORM_FIFO_SIZE> waveformFifo;
+};
@@ -0,0 +1,229 @@
+/*
+  ==============================================================================
+
+    FeedbackFilters.cpp
+
+  ==============================================================================
+*/
+
+#include "FeedbackFilters.h"
+#include <algorithm>
+
+#if defined(DELAY_NO_SIMD)
+ // scalar code only, for testing it against the SIMD builds
+#elif defined(_STK_FLOAT32_) && (defined(__SSE__) || defined(_M_X64) || defined(_M_IX86_FP))
+ #include <xmmintrin.h>
+ #define FEEDBACK_FILTERS_SSE 1
+#elif defined(_STK_FLOAT32_) && defined(__ARM_NEON)
+ #include <arm_neon.h>
+ #define FEEDBACK_FILTERS_NEON 1
+#endif
+
+namespace {
+
+/* 4-lane vector wrappers so the kernel is only written once */
+#if FEEDBACK_FILTERS_SSE
+struct Lanes
+{
+    __m128 v;
+
+    static Lanes load(const float* p) { return { _mm_load_ps(p) }; }
+    static Lanes set1(float x) { return { _mm_set1_ps(x) }; }
+    void store(float* p) const { _mm_store_ps(p, v); }
+
+    // [left, right, lowPassOut[0], lowPassOut[1]]
+    static Lanes input(float left, float right, Lanes lowPassOut) {
+        return { _mm_movelh_ps(_mm_setr_ps(left, right, 0, 0), lowPassOut.v) };
+    }
+
+    template <int i> float get() const { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(i, i, i, i))); }
+
+    Lanes operator+(Lanes o) const { return { _mm_add_ps(v, o.v) }; }
+    Lanes operator-(Lanes o) const { return { _mm_sub_ps(v, o.v) }; }
+    Lanes operator*(Lanes o) const { return { _mm_mul_ps(v, o.v) }; }
+};
+#elif FEEDBACK_FILTERS_NEON
+struct Lanes
+{
+    float32x4_t v;
+
+    static Lanes load(const float* p) { return { vld1q_f32(p) }; }
+    static Lanes set1(float x) { return { vdupq_n_f32(x) }; }
+    void store(float* p) const { vst1q_f32(p, v); }
+
+    static Lanes input(float left, float right, Lanes lowPassOut) {
+        float32x2_t lr = vset_lane_f32(right, vdup_n_f32(left), 1);
+        return { vcombine_f32(lr, vget_low_f32(lowPassOut.v)) };
+    }
+
+    template <int i> float get() const { return vgetq_lane_f32(v, i); }
+
+    Lanes operator+(Lanes o) const { return { vaddq_f32(v, o.v) }; }
+    Lanes operator-(Lanes o) const { return { vsubq_f32(v, o.v) }; }
+    Lanes operator*(Lanes o) const { return { vmulq_f32(v, o.v) }; }
+};
+#else
+struct Lanes
+{
+    stk::StkFloat v[FeedbackFilters::numLanes];
+
+    static Lanes load(const stk::StkFloat* p) { return { { p[0], p[1], p[2], p[3] } }; }
+    static Lanes set1(stk::StkFloat x) { return { { x, x, x, x } }; }
+    void store(stk::StkFloat* p) const { for (int i = 0; i < 4; i++) p[i] = v[i]; }
+
+    static Lanes input(stk::StkFloat left, stk::StkFloat right, Lanes lowPassOut) {
+        return { { left, right, lowPassOut.v[0], lowPassOut.v[1] } };
+    }
+
+    template <int i> stk::StkFloat get() const { return v[i]; }
+
+    Lanes operator+(Lanes o) const { return { { v[0] + o.v[0], v[1] + o.v[1], v[2] + o.v[2], v[3] + o.v[3] } }; }
+    Lanes operator-(Lanes o) const { return { { v[0] - o.v[0], v[1] - o.v[1], v[2] - o.v[2], v[3] - o.v[3] } }; }
+    Lanes operator*(Lanes o) const { return { { v[0] * o.v[0], v[1] * o.v[1], v[2] * o.v[2], v[3] * o.v[3] } }; }
+};
+#endif
+
+}
+
+FeedbackFilters::FeedbackFilters() : rampSampsLeft(0), rampPos(0) {
+    // pass-through until coefficients are set, like stk::BiQuad
+    for (int lane = 0; lane < numLanes; lane++) {
+        for (int c = 0; c < numCoeffs; c++) {
+            coeffs[c][lane] = targetCoeffs[c][lane] = c == b0Index ? 1 : 0;
+            coeffSteps[c][lane] = 0;
+            rampOrigins[c][lane] = coeffs[c][lane];
+            rampSteps[c][lane] = 0;
+        }
+    }
+    clear();
+}
+
+void FeedbackFilters::setCoeffs(int lane, const float* newCoeffs, int rampSamps) {
+    for (int c = 0; c < numCoeffs; c++)
+        targetCoeffs[c][lane] = newCoeffs[c];
+
+    if (rampSamps <= 0) {
+        for (int c = 0; c < numCoeffs; c++) {
+            coeffs[c][lane] = targetCoeffs[c][lane];
+            coeffSteps[c][lane] = 0;
+            rampOrigins[c][lane] = targetCoeffs[c][lane];
+            rampSteps[c][lane] = 0;
+        }
+        return;
+    }
+
+    // one shared ramp for all lanes: lanes already on their way are re-timed to finish with this one,
+    // starting from where they are at full precision
+    for (int l = 0; l < numLanes; l++) {
+        for (int c = 0; c < numCoeffs; c++) {
+            double current = rampSampsLeft > 0 ? rampOrigins[c][l] + rampSteps[c][l]*rampPos : coeffs[c][l];
+            rampOrigins[c][l] = current;
+            rampSteps[c][l] = (targetCoeffs[c][l] - current)/rampSamps;
+            coeffs[c][l] = current;
+            coeffSteps[c][l] = rampSteps[c][l];
+        }
+    }
+    rampSampsLeft = rampSamps;
+    rampPos = 0;
+}
+
+void FeedbackFilters::setLowPassCoeffs(int channel, const float* newCoeffs, int rampSamps) {
+    setCoeffs(channel, newCoeffs, rampSamps);
+}
+
+void FeedbackFilters::setHighPassCoeffs(int channel, const float* newCoeffs, int rampSamps) {
+    setCoeffs(2 + channel, newCoeffs, rampSamps);
+}
+
+void FeedbackFilters::clear() {
+    for (int lane = 0; lane < numLanes; lane++)
+        x1[lane] = x2[lane] = y1[lane] = y2[lane] = 0;
+}
+
+void FeedbackFilters::process(stk::StkFloat* left, stk::StkFloat* right, int numSamples) {
+    if (numSamples <= 0)
+        return;
+
+    Lanes B0 = Lanes::load(coeffs[b0Index]), B1 = Lanes::load(coeffs[b1Index]), B2 = Lanes::load(coeffs[b2Index]);
+    Lanes A1 = Lanes::load(coeffs[a1Index]), A2 = Lanes::load(coeffs[a2Index]);
+    Lanes X1 = Lanes::load(x1), X2 = Lanes::load(x2);
+    Lanes Y1 = Lanes::load(y1), Y2 = Lanes::load(y2);
+    Lanes y;
+
+    // same operation order as stk::BiQuad::tick
+    auto step = [&](Lanes in) {
+        y = B0*in + B1*X1 + B2*X2;
+        y = y - (A2*Y2 + A1*Y1);
+        X2 = X1;
+        X1 = in;
+        Y2 = Y1;
+        Y1 = y;
+    };
+
+    /* Coefficient ramp: one step after each low pass step while it lasts, each one computed
+       from the coefficients at the start of the block so rounding doesn't add up */
+    const int rampSamps = std::min(numSamples, rampSampsLeft);
+    const Lanes startB0 = B0, startB1 = B1, startB2 = B2, startA1 = A1, startA2 = A2;
+    const Lanes dB0 = Lanes::load(coeffSteps[b0Index]), dB1 = Lanes::load(coeffSteps[b1Index]);
+    const Lanes dB2 = Lanes::load(coeffSteps[b2Index]), dA1 = Lanes::load(coeffSteps[a1Index]);
+    const Lanes dA2 = Lanes::load(coeffSteps[a2Index]);
+    const Lanes one = Lanes::set1(1);
+    Lanes rampCount = Lanes::set1(0);
+    auto rampStep = [&]() {
+        rampCount = rampCount + one;
+        B0 = startB0 + dB0*rampCount; B1 = startB1 + dB1*rampCount; B2 = startB2 + dB2*rampCount;
+        A1 = startA1 + dA1*rampCount; A2 = startA2 + dA2*rampCount;
+    };
+
+    // Keeps the state of lanes [first, first + 1] from before the last step,
+    // used when only half of the lanes had real input.
+    auto restoreLanes = [&](int first, const stk::StkFloat* saved) {
+        X1.store(x1); X2.store(x2); Y1.store(y1); Y2.store(y2);
+        for (int lane = first; lane < first + 2; lane++) {
+            x1[lane] = saved[0 + lane - first];
+            x2[lane] = saved[2 + lane - first];
+            y1[lane] = saved[4 + lane - first];
+            y2[lane] = saved[6 + lane - first];
+        }
+        X1 = Lanes::load(x1); X2 = Lanes::load(x2); Y1 = Lanes::load(y1); Y2 = Lanes::load(y2);
+    };
+
+    /* First sample only goes through the low pass lanes */
+    stk::StkFloat saved[8] = { x1[2], x1[3], x2[2], x2[3], y1[2], y1[3], y2[2], y2[3] };
+    step(Lanes::input(left[0], right[0], Lanes::load(x1)));
+    restoreLanes(2, saved);
+    if (rampSamps > 0)
+        rampStep();
+
+    /* Low pass on sample i, high pass on sample i - 1 */
+    int i = 1;
+    for (; i < rampSamps; i++) {
+        step(Lanes::input(left[i], right[i], y));
+        left[i - 1] = y.get<2>();
+        right[i - 1] = y.get<3>();
+        rampStep();
+    }
+    for (; i < numSamples; i++) {
+        step(Lanes::input(left[i], right[i], y));
+        left[i - 1] = y.get<2>();
+        right[i - 1] = y.get<3>();
+    }
+
+    /* Last sample only goes through the high pass lanes */
+    X1.store(x1); X2.store(x2); Y1.store(y1); Y2.store(y2);
+    stk::StkFloat savedLowPass[8] = { x1[0], x1[1], x2[0], x2[1], y1[0], y1[1], y2[0], y2[1] };
+    step(Lanes::input(0, 0, y));
+    left[numSamples - 1] = y.get<2>();
+    right[numSamples - 1] = y.get<3>();
+    restoreLanes(0, savedLowPass);
+
+    if (rampSamps > 0) {
+        rampSampsLeft -= rampSamps;
+        rampPos += rampSamps;
+        // the next block starts from the exact point on the ramp, or exactly on the targets
+        for (int c = 0; c < numCoeffs; c++)
+            for (int lane = 0; lane < numLanes; lane++)
+                coeffs[c][lane] = rampSampsLeft == 0 ? targetCoeffs[c][lane]
+                                                     : rampOrigins[c][lane] + rampSteps[c][lane]*rampPos;
+    }
+}
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    FeedbackFilters.h
+
+    The low pass and high pass from both feedback loops, run together as one
+    packed 4-lane biquad.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "StkLite-4.6.1/Stk.h"
+
+/* Lanes are [left LP, right LP, left HP, right HP]. The high pass lanes run one sample
+   behind the low pass lanes, taking the low pass output from the previous step, so all
+   four filters advance together on every step and the cascade costs about as much as a
+   single biquad.
+
+   Uses SSE or NEON when StkFloat is a float (_STK_FLOAT32_), otherwise (or with DELAY_NO_SIMD)
+   a scalar fallback that runs the same steps lane by lane. Each lane computes exactly what stk::BiQuad::tick
+   computes, in the same order.
+
+   New coefficients can be ramped in linearly over a number of samples. Linear steps between
+   two stable low/high pass designs stay stable (the stable (a1, a2) region is convex), and
+   cost one multiply-add per coefficient per sample. Each step is computed from the point the
+   ramp started rather than by adding up increments: at Q = 0.5 these filters have a double
+   pole, which rounding errors in a1 and a2 split apart by roughly their square root, so the
+   drift from summing increments over a long automation pushes low cutoffs unstable. */
+class FeedbackFilters
+{
+public:
+    FeedbackFilters();
+
+    // coeffs = [b0, b1, b2, a1, a2] as produced by Mu45FilterCalc
+    // rampSamps = 0 switches immediately, otherwise all lanes glide to their targets over rampSamps
+    void setLowPassCoeffs(int channel, const float* coeffs, int rampSamps = 0);
+    void setHighPassCoeffs(int channel, const float* coeffs, int rampSamps = 0);
+
+    // clears the filter state
+    void clear();
+
+    // low pass then high pass, in place, on numSamples of each channel
+    void process(stk::StkFloat* left, stk::StkFloat* right, int numSamples);
+
+    static constexpr int numLanes = 4;
+
+private:
+    enum { b0Index, b1Index, b2Index, a1Index, a2Index, numCoeffs };
+
+    void setCoeffs(int lane, const float* coeffs, int rampSamps);
+
+    alignas(16) stk::StkFloat coeffs[numCoeffs][numLanes];       // current
+    alignas(16) stk::StkFloat targetCoeffs[numCoeffs][numLanes];
+    alignas(16) stk::StkFloat coeffSteps[numCoeffs][numLanes];   // per-sample increments while ramping
+    double rampOrigins[numCoeffs][numLanes]; // coefficients where the ramp started
+    double rampSteps[numCoeffs][numLanes];   // coeffSteps at full precision
+    int rampSampsLeft;
+    int rampPos; // samples since the ramp started
+
+    alignas(16) stk::StkFloat x1[numLanes], x2[numLanes], y1[numLanes], y2[numLanes];
+};
@@ -0,0 +1,23 @@
+/*
+  ==============================================================================
+
+    FeedbackGain.h
+
+    The Feedback parameter's curve, shared by the plugin and everything that
+    renders through DelayEngine outside of it. No JUCE dependency.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+
+// convert percentage to gain for feedback (using dB scale):
+// 1 to 100 % -> -19.8 to 0 dB, 0 % is off
+inline float determineFeedbackGain(float percent) {
+    if (percent == 0)
+        return 0;
+    float scaled_val = (100-percent)/5.0;
+    return std::pow(10, -scaled_val/20.0);
+}
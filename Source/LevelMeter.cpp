@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    LevelMeter.cpp
+
+  ==============================================================================
+*/
+
+#include "LevelMeter.h"
+#include <algorithm>
+#include <cmath>
+
+static float gainToDb(float gain) {
+    return gain > 0 ? std::max<float>(20*std::log10(gain), METER_DB_MIN) : METER_DB_MIN;
+}
+
+LevelMeter::LevelMeter() : peakDb(METER_DB_MIN), rmsDb(METER_DB_MIN), peakY(0), rmsY(0) {
+    setOpaque(true);
+    setInterceptsMouseClicks(false, false);
+}
+
+int LevelMeter::dbToY(float db) const {
+    float proportion = (db - METER_DB_MIN)/(float) (METER_DB_MAX - METER_DB_MIN);
+    return (int) std::round((1 - std::min(proportion, 1.0f))*getHeight());
+}
+
+void LevelMeter::setLevels(float peak, float rms, float secondsElapsed) {
+    float fall = METER_RELEASE_DB_PER_S*secondsElapsed;
+    peakDb = std::max(gainToDb(peak), peakDb - fall);
+    rmsDb = std::max(gainToDb(rms), rmsDb - fall);
+
+    int newPeakY = dbToY(peakDb);
+    int newRmsY = dbToY(rmsDb);
+    if (newPeakY != peakY || newRmsY != rmsY) {
+        peakY = newPeakY;
+        rmsY = newRmsY;
+        repaint();
+    }
+}
+
+void LevelMeter::paint(juce::Graphics& g) {
+    g.fillAll(juce::Colours::black);
+
+    // 0 dB mark
+    g.setColour(juce::Colours::darkgrey);
+    g.drawHorizontalLine(dbToY(0), 0, getWidth());
+
+    g.setColour(rmsDb > 0 ? juce::Colours::red : juce::Colours::green);
+    g.fillRect(0, rmsY, getWidth(), getHeight() - rmsY);
+
+    if (peakDb > METER_DB_MIN) {
+        g.setColour(peakDb > 0 ? juce::Colours::red : juce::Colours::yellow);
+        g.fillRect(0, peakY, getWidth(), 2);
+    }
+}
+
+void LevelMeter::resized() {
+    peakY = dbToY(peakDb);
+    rmsY = dbToY(rmsDb);
+}
@@ -0,0 +1,42 @@
+/*
+  ==============================================================================
+
+    LevelMeter.h
+
+    A vertical bar meter: RMS as the filled bar, peak as a line above it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Defines.h"
+
+/* Levels are shown in dB from METER_DB_MIN to METER_DB_MAX. Rises show up at once and
+   falls are limited to METER_RELEASE_DB_PER_S, so the bars stay readable at the editor's
+   update rate. Only repaints when the bar or the peak line moves by a whole pixel. */
+class LevelMeter  : public juce::Component
+{
+public:
+    LevelMeter();
+
+    // peak and rms are linear gains measured over the last secondsElapsed
+    void setLevels(float peak, float rms, float secondsElapsed);
+
+    // true once both the bar and the peak line have fallen to the bottom
+    bool isResting() const { return peakDb <= METER_DB_MIN && rmsDb <= METER_DB_MIN; }
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    float peakDb;
+    float rmsDb;
+    int peakY; // pixel rows the current levels were last painted at
+    int rmsY;
+
+    int dbToY(float db) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeter)
+};
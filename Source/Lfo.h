@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    Lfo.h
+
+    Low frequency oscillator for the delay time modulation, filled a block
+    at a time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "StkLite-4.6.1/Stk.h"
+#include <cmath>
+
+/* Unipolar: the output goes from 0 up to 1 and back, starting at 0 at phase 0, so it can
+   only lengthen the delay it modulates. The phase of every sample in a block is worked out
+   from the start of the block rather than carried from sample to sample, so the loops
+   vectorize, and the sine (a raised cosine, sin^2(pi p)) comes from a polynomial instead of
+   std::sin.
+
+   Like stk::Delay's block reads, fill() doesn't move the phase on; advance() does. */
+class Lfo
+{
+public:
+    enum Waveform { sine, triangle, numWaveforms };
+
+    void setRate(float cyclesPerSample) { increment = cyclesPerSample; }
+    void setWaveform(Waveform newWaveform) { waveform = newWaveform; }
+    void setPhase(double cycles) { phase = cycles - std::floor(cycles); }
+
+    // writes the next numSamples values to out
+    void fill(stk::StkFloat* out, int numSamples) const {
+        // the phase wraps every cycle, so a float holds it closely enough within a block
+        const float start = (float) phase, step = increment;
+        for (int i = 0; i < numSamples; i++) {
+            float p = start + i*step;
+            p -= (int) p; // the same as floor(), p isn't negative
+            out[i] = 1 - std::abs(1 - 2*p); // triangle
+        }
+        if (waveform == sine)
+            for (int i = 0; i < numSamples; i++)
+                out[i] = sineSquared(out[i]);
+    }
+
+    void advance(int numSamples) {
+        phase += (double) numSamples*increment;
+        phase -= std::floor(phase);
+    }
+
+private:
+    // sin^2(pi/2 t) for t in [0, 1], which turns the triangle into a raised cosine.
+    // sin() is a degree 9 Taylor polynomial, accurate to about 4e-6
+    static stk::StkFloat sineSquared(stk::StkFloat t) {
+        const stk::StkFloat c1 = 1.5707963, c3 = -0.6459641, c5 = 0.0796926, c7 = -0.0046817, c9 = 0.0001605;
+        stk::StkFloat t2 = t*t;
+        stk::StkFloat s = t*(c1 + t2*(c3 + t2*(c5 + t2*(c7 + t2*c9))));
+        return s*s;
+    }
+
+    double phase = 0; // cycles, 0 to 1
+    float increment = 0; // cycles per sample
+    Waveform waveform = sine;
+};
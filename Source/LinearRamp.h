@@ -0,0 +1,48 @@
+/*
+  ==============================================================================
+
+    LinearRamp.h
+
+    Per-sample parameter smoothing shared by the DSP classes.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "StkLite-4.6.1/Stk.h"
+#include <algorithm>
+
+/* Linear ramp from the current value to a target */
+struct LinearRamp
+{
+    float current = 0;
+    float target = 0;
+    float step = 0;
+    int stepsLeft = 0;
+
+    // rampSamps <= 0 jumps straight to newTarget
+    void setTarget(float newTarget, int rampSamps) {
+        target = newTarget;
+        if (rampSamps <= 0 || newTarget == current) {
+            current = newTarget;
+            stepsLeft = 0;
+            return;
+        }
+        step = (target - current)/rampSamps;
+        stepsLeft = rampSamps;
+    }
+
+    bool isRamping() const { return stepsLeft > 0; }
+
+    // writes the next numSamples values to out and moves the ramp along
+    void fill(stk::StkFloat* out, int numSamples) {
+        int n = std::min(numSamples, stepsLeft);
+        for (int i = 0; i < n; i++)
+            out[i] = current + step*i;
+        for (int i = n; i < numSamples; i++)
+            out[i] = target;
+        stepsLeft -= n;
+        current = stepsLeft > 0 ? current + step*n : target;
+    }
+};
@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    MultiTapDelay.cpp
+
+  ==============================================================================
+*/
+
+#include "MultiTapDelay.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+MultiTapDelay::MultiTapDelay(int maxBlockSize) : line(std::vector<unsigned long>(maxTaps, 0)) {
+    tapFrames.resize(maxBlockSize, 1);
+    for (stk::StkFrames& frames : gainFrames)
+        frames.resize(maxBlockSize, 1);
+}
+
+void MultiTapDelay::setMaximumDelay(unsigned long samps) {
+    line.setMaximumDelay(samps);
+}
+
+void MultiTapDelay::setCrossfade(unsigned long samps) {
+    line.setCrossfade(samps);
+}
+
+void MultiTapDelay::clear(unsigned long recentSamps) {
+    line.clearRecent(recentSamps);
+}
+
+void MultiTapDelay::setTap(int tap, unsigned long delaySamps, float gain, float pan, bool feedback, int rampSamps) {
+    line.setTapDelay(tap, delaySamps);
+    if (rampSamps <= 0)
+        line.endCrossfade(tap);
+
+    // equal power: -3 dB on each side in the middle
+    const double angle = (pan + 1)*M_PI/4;
+    gains[tap][leftGain].setTarget(gain*std::cos(angle), rampSamps);
+    gains[tap][rightGain].setTarget(gain*std::sin(angle), rampSamps);
+    gains[tap][feedbackGain].setTarget(feedback ? gain : 0, rampSamps);
+}
+
+bool MultiTapDelay::isAudible(int tap) const {
+    for (const LinearRamp& gain : gains[tap])
+        if (gain.current != 0 || gain.isRamping())
+            return true;
+    return false;
+}
+
+unsigned long MultiTapDelay::getMinimumReadDelay() const {
+    unsigned long minDelay = std::numeric_limits<unsigned long>::max();
+    for (int tap = 0; tap < maxTaps; tap++)
+        if (isAudible(tap))
+            minDelay = std::min(minDelay, line.getMinimumReadDelay(tap));
+    return minDelay;
+}
+
+unsigned long MultiTapDelay::getMaximumReadDelay() const {
+    unsigned long maxDelay = 0;
+    for (int tap = 0; tap < maxTaps; tap++)
+        if (isAudible(tap))
+            maxDelay = std::max(maxDelay, line.getMaximumReadDelay(tap));
+    return maxDelay;
+}
+
+float MultiTapDelay::getFeedbackGain() const {
+    float sum = 0;
+    for (int tap = 0; tap < maxTaps; tap++)
+        sum += gains[tap][feedbackGain].target;
+    return sum;
+}
+
+// out += gain*in
+static void addScaled(stk::StkFloat* out, const stk::StkFloat* in, float gain, int numSamples) {
+    for (int i = 0; i < numSamples; i++)
+        out[i] += gain*in[i];
+}
+
+// out += gains*in, per sample
+static void addScaled(stk::StkFloat* out, const stk::StkFloat* in, const stk::StkFloat* gains, int numSamples) {
+    for (int i = 0; i < numSamples; i++)
+        out[i] += gains[i]*in[i];
+}
+
+void MultiTapDelay::read(stk::StkFloat* left, stk::StkFloat* right, stk::StkFloat* feedback, int numSamples) {
+    std::memset(left, 0, numSamples*sizeof(stk::StkFloat));
+    std::memset(right, 0, numSamples*sizeof(stk::StkFloat));
+    std::memset(feedback, 0, numSamples*sizeof(stk::StkFloat));
+    stk::StkFloat* const sums[numGains] = { left, right, feedback };
+
+    for (int tap = 0; tap < maxTaps; tap++) {
+        if (! isAudible(tap))
+            continue;
+
+        /* The tap's output, straight from the line unless it is crossfading */
+        stk::StkFloat* data[2];
+        unsigned long sizes[2];
+        unsigned int numSpans;
+        if (line.isCrossfading(tap)) {
+            line.readBlock(tap, &tapFrames[0], numSamples);
+            data[0] = &tapFrames[0];
+            sizes[0] = numSamples;
+            numSpans = 1;
+        }
+        else {
+            numSpans = line.tapSpans(tap, numSamples, data, sizes);
+        }
+
+        bool ramping = false;
+        for (const LinearRamp& gain : gains[tap])
+            ramping = ramping || gain.isRamping();
+
+        if (ramping) {
+            for (int g = 0; g < numGains; g++)
+                gains[tap][g].fill(&gainFrames[g][0], numSamples);
+            for (int g = 0; g < numGains; g++) {
+                int pos = 0;
+                for (unsigned int s = 0; s < numSpans; s++) {
+                    addScaled(sums[g] + pos, data[s], &gainFrames[g][pos], (int) sizes[s]);
+                    pos += (int) sizes[s];
+                }
+            }
+        }
+        else {
+            for (int g = 0; g < numGains; g++) {
+                const float gain = gains[tap][g].current;
+                if (gain == 0)
+                    continue;
+                int pos = 0;
+                for (unsigned int s = 0; s < numSpans; s++) {
+                    addScaled(sums[g] + pos, data[s], gain, (int) sizes[s]);
+                    pos += (int) sizes[s];
+                }
+            }
+        }
+    }
+}
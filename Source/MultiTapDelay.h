@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    MultiTapDelay.h
+
+    Up to MULTITAP_NUM_TAPS_MAX taps, each with its own time, gain, pan and
+    feedback send, all reading one shared delay line.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "StkLite-4.6.1/TapDelay.h"
+#include "LinearRamp.h"
+#include "Defines.h"
+
+/* One mono stk::TapDelay line is read by every tap, so the memory and the write cost
+   don't grow with the tap count. Tap time changes crossfade from the old read position
+   to the new one (done by stk::TapDelay), and gains ramp like DelayEngine's.
+
+   read() mixes a whole block of every tap at once. Each tap is read straight out of the
+   line's storage, as one or two contiguous spans, and added into the left, right and
+   feedback sums with a multiply-add per sample, so a tap costs a few short loops the
+   compiler vectorizes and nothing per sample besides. Silent taps are skipped.
+
+   Like stk::Delay in DelayEngine, a block must not be longer than the shortest delay
+   being read (getMinimumReadDelay()), and read() comes before write() for each block. */
+class MultiTapDelay
+{
+public:
+    static constexpr int maxTaps = MULTITAP_NUM_TAPS_MAX;
+
+    // reserves scratch space for blocks of up to maxBlockSize
+    MultiTapDelay(int maxBlockSize);
+
+    // may allocate, see stk::TapDelay::setMaximumDelay
+    void setMaximumDelay(unsigned long samps);
+    void setCrossfade(unsigned long samps);
+
+    // clears the last recentSamps inputs, the only ones delays shorter than that can read
+    void clear(unsigned long recentSamps);
+
+    // gain is linear, pan goes from -1 (left) to 1 (right) with an equal-power law.
+    // feedback picks whether the tap is sent back into the line.
+    // rampSamps <= 0 applies everything at once, including the tap time
+    void setTap(int tap, unsigned long delaySamps, float gain, float pan, bool feedback, int rampSamps);
+
+    // shortest delay any audible tap reads, so the longest block read() can do
+    unsigned long getMinimumReadDelay() const;
+    // longest delay any audible tap reads, 0 if none is
+    unsigned long getMaximumReadDelay() const;
+    // sum of the taps' feedback gains, once they have finished ramping
+    float getFeedbackGain() const;
+
+    // sets left, right and feedback to the sums of the next numSamples of every tap,
+    // each scaled by its left, right and feedback gain
+    void read(stk::StkFloat* left, stk::StkFloat* right, stk::StkFloat* feedback, int numSamples);
+
+    // writes the next numSamples into the line
+    void write(const stk::StkFloat* in, int numSamples) { line.writeBlock(in, numSamples); }
+
+private:
+    enum { leftGain, rightGain, feedbackGain, numGains };
+
+    bool isAudible(int tap) const;
+
+    stk::TapDelay line;
+    LinearRamp gains[maxTaps][numGains];
+
+    stk::StkFrames tapFrames; // one tap's output while it crossfades
+    stk::StkFrames gainFrames[numGains]; // one tap's gains while they ramp
+};
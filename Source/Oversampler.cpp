@@ -0,0 +1,163 @@
+/*
+  ==============================================================================
+
+    Oversampler.cpp
+
+  ==============================================================================
+*/
+
+#include "Oversampler.h"
+#include <algorithm>
+#include <cmath>
+
+/* Half-band designs. Up to 0.42 of the host rate both pass within 0.001 dB, and what
+   lands from above 0.58 of it is at least 79 dB down. The second step only has to
+   separate the host band from its images at 2x, so it can be much shorter. */
+static const int firstNumCoeffs = 16;  // 63 taps, 31 samples of latency at the host rate
+static const double firstBeta = 8;
+static const int secondNumCoeffs = 6;  // 23 taps
+static const double secondBeta = 7;
+
+// zeroth-order modified Bessel function of the first kind, from its power series
+static double besselI0(double x) {
+    double term = 1, sum = 1;
+    for (int n = 1; n < 32; n++) {
+        term *= (x/(2*n))*(x/(2*n));
+        sum += term;
+    }
+    return sum;
+}
+
+HalfBandFilter::HalfBandFilter(int coeffCount, double kaiserBeta, int maxBlockSize)
+    : numCoeffs(coeffCount), coeffs(coeffCount), historySize(2*coeffCount) {
+    // ideal half-band: sin(pi n/2)/(pi n), which is (-1)^j/(pi (2j + 1)) at the odd taps.
+    // Scaled so the taps sum to 1 (no gain at DC) with the centre at exactly 1/2
+    double sum = 0;
+    for (int j = 0; j < numCoeffs; j++) {
+        double offset = 2*j + 1;
+        double r = offset/historySize;
+        double window = besselI0(kaiserBeta*std::sqrt(1 - r*r))/besselI0(kaiserBeta);
+        coeffs[j] = (j % 2 ? -1 : 1)/(M_PI*offset)*window;
+        sum += coeffs[j];
+    }
+    for (float& c : coeffs)
+        c *= 0.25/sum;
+
+    upInput.resize(historySize + maxBlockSize);
+    downEven.resize(historySize + maxBlockSize);
+    downOdd.resize(historySize + maxBlockSize);
+    sums.resize(maxBlockSize);
+    reset();
+}
+
+void HalfBandFilter::reset() {
+    std::fill(upInput.begin(), upInput.end(), 0.0f);
+    std::fill(downEven.begin(), downEven.end(), 0.0f);
+    std::fill(downOdd.begin(), downOdd.end(), 0.0f);
+}
+
+void HalfBandFilter::upsample(const float* in, float* out, int numSamples) {
+    // x[m] is input m of this block, x[-1] the one before it and so on
+    float* x = upInput.data() + historySize;
+    std::copy(in, in + numSamples, x);
+
+    // even outputs: 2 sum_j c_j (x[m - K - j] + x[m - K + 1 + j]), with K = numCoeffs.
+    // The zero stuffing halves the level, hence the 2
+    float* even = sums.data();
+    std::fill(even, even + numSamples, 0.0f);
+    for (int j = 0; j < numCoeffs; j++) {
+        const float c = 2*coeffs[j];
+        const float* older = x - numCoeffs - j;
+        const float* newer = x - numCoeffs + 1 + j;
+        for (int m = 0; m < numSamples; m++)
+            even[m] += c*(older[m] + newer[m]);
+    }
+
+    // odd outputs: the centre tap alone, x[m - K + 1]
+    const float* centre = x - numCoeffs + 1;
+    for (int m = 0; m < numSamples; m++) {
+        out[2*m] = even[m];
+        out[2*m + 1] = centre[m];
+    }
+
+    std::copy(x + numSamples - historySize, x + numSamples, upInput.data());
+}
+
+void HalfBandFilter::downsample(const float* in, float* out, int numSamples) {
+    float* even = downEven.data() + historySize;
+    float* odd = downOdd.data() + historySize;
+    for (int m = 0; m < numSamples; m++) {
+        even[m] = in[2*m];
+        odd[m] = in[2*m + 1];
+    }
+
+    // out[m] = odd[m - K]/2 + sum_j c_j (even[m - K - j] + even[m - K + 1 + j])
+    const float* centre = odd - numCoeffs;
+    for (int m = 0; m < numSamples; m++)
+        out[m] = 0.5f*centre[m];
+    for (int j = 0; j < numCoeffs; j++) {
+        const float c = coeffs[j];
+        const float* older = even - numCoeffs - j;
+        const float* newer = even - numCoeffs + 1 + j;
+        for (int m = 0; m < numSamples; m++)
+            out[m] += c*(older[m] + newer[m]);
+    }
+
+    std::copy(even + numSamples - historySize, even + numSamples, downEven.data());
+    std::copy(odd + numSamples - historySize, odd + numSamples, downOdd.data());
+}
+
+Oversampler::Oversampler(int maxOversampledSize)
+    : factor(1), first(firstNumCoeffs, firstBeta, maxOversampledSize/2),
+      second(secondNumCoeffs, secondBeta, maxOversampledSize/2), middle(maxOversampledSize/2), padSample(0) {
+}
+
+void Oversampler::setFactor(int newFactor) {
+    factor = newFactor;
+    reset();
+}
+
+void Oversampler::reset() {
+    first.reset();
+    second.reset();
+    padSample = 0;
+}
+
+void Oversampler::upsample(const float* in, float* out, int numSamples) {
+    if (factor == 1) {
+        std::copy(in, in + numSamples, out);
+    }
+    else if (factor == 2) {
+        first.upsample(in, out, numSamples);
+    }
+    else {
+        first.upsample(in, middle.data(), numSamples);
+        second.upsample(middle.data(), out, 2*numSamples);
+    }
+}
+
+void Oversampler::downsample(const float* in, float* out, int numSamples) {
+    if (factor == 1) {
+        std::copy(in, in + numSamples, out);
+    }
+    else if (factor == 2) {
+        first.downsample(in, out, numSamples);
+    }
+    else {
+        float* m = middle.data();
+        second.downsample(in, m, 2*numSamples);
+        float last = m[2*numSamples - 1];
+        std::copy_backward(m, m + 2*numSamples - 1, m + 2*numSamples);
+        m[0] = padSample;
+        padSample = last;
+        first.downsample(m, out, numSamples);
+    }
+}
+
+int Oversampler::getLatency() const {
+    if (factor == 1)
+        return 0;
+    if (factor == 2)
+        return first.getLatency();
+    return first.getLatency() + (second.getLatency() + 1)/2;
+}
@@ -0,0 +1,80 @@
+/*
+  ==============================================================================
+
+    Oversampler.h
+
+    2x and 4x up and down sampling with polyphase half-band FIR filters,
+    for running the delay engine at a higher rate.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <vector>
+
+/* One 2x step for one channel: the state to upsample a signal and to downsample one.
+
+   The filter is a linear-phase, Kaiser-windowed half-band of 4*numCoeffs - 1 taps. Every
+   other tap is zero and the centre one is 1/2, so in polyphase form each output only needs
+   numCoeffs multiply-adds: the upsampler's odd outputs are just the input delayed, and the
+   downsampler's odd inputs only meet the centre tap. The remaining sums run over the whole
+   block one coefficient at a time (so they vectorize), on linear buffers that keep the
+   last 2*numCoeffs inputs in front of the block. */
+class HalfBandFilter
+{
+public:
+    // maxBlockSize is the most samples at the lower rate per call
+    HalfBandFilter(int coeffCount, double kaiserBeta, int maxBlockSize);
+
+    void reset();
+
+    // out gets 2*numSamples samples
+    void upsample(const float* in, float* out, int numSamples);
+    // in has 2*numSamples samples
+    void downsample(const float* in, float* out, int numSamples);
+
+    // of upsampling and downsampling together, in samples at the lower rate
+    int getLatency() const { return 2*numCoeffs - 1; }
+
+private:
+    int numCoeffs;
+    std::vector<float> coeffs; // the taps 2j + 1 either side of the centre, j = 0 to numCoeffs - 1
+    int historySize;
+
+    std::vector<float> upInput; // history, then the block
+    std::vector<float> downEven;
+    std::vector<float> downOdd;
+    std::vector<float> sums; // scratch
+};
+
+/* 2x (one half-band step) or 4x (two) oversampling of one channel. In 4x mode the second
+   step's latency is an odd number of 2x samples, so the way down is padded by one of them
+   to keep the total latency a whole number of samples at the host rate. */
+class Oversampler
+{
+public:
+    // maxOversampledSize is the most samples per call at the oversampled rate
+    explicit Oversampler(int maxOversampledSize);
+
+    // 1, 2 or 4. Clears the state
+    void setFactor(int newFactor);
+    int getFactor() const { return factor; }
+
+    void reset();
+
+    // out gets numSamples*getFactor() samples
+    void upsample(const float* in, float* out, int numSamples);
+    // in has numSamples*getFactor() samples
+    void downsample(const float* in, float* out, int numSamples);
+
+    // of upsampling and downsampling together, in samples at the host rate
+    int getLatency() const;
+
+private:
+    int factor;
+    HalfBandFilter first;  // host rate <-> 2x
+    HalfBandFilter second; // 2x <-> 4x
+    std::vector<float> middle; // the 2x signal between the two steps
+    float padSample; // the last 2x sample on the way down, delayed by one
+};
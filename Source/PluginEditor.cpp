@@ -84,13 +84,28 @@ void ColemanJP03DelayAudioProcessorEditor::makeFcValLabel(int x, juce::Label& la
     addAndMakeVisible(label);
 }
 
+// a label and an L/R pair of meters for one metering point
+void ColemanJP03DelayAudioProcessorEditor::makeMeters(int x, LevelFrame::Point point, std::string labelText) {
+    juce::Label& label = meterLabels[point];
+    label.setText(labelText, juce::dontSendNotification);
+    label.setBounds(x, 1*UNIT_LENGTH_Y, 2*UNIT_LENGTH_X, 2*UNIT_LENGTH_Y);
+    label.setJustificationType(juce::Justification::centred);
+    label.setFont(juce::Font (16.0f, juce::Font::bold));
+    addAndMakeVisible(label);
+    
+    for (int ch = 0; ch < LevelFrame::numChannels; ch++) {
+        meters[point][ch].setBounds(x + ch*UNIT_LENGTH_X + 2, 3.5*UNIT_LENGTH_Y, UNIT_LENGTH_X - 4, 18*UNIT_LENGTH_Y);
+        addAndMakeVisible(meters[point][ch]);
+    }
+}
+
 //==============================================================================
 ColemanJP03DelayAudioProcessorEditor::ColemanJP03DelayAudioProcessorEditor (ColemanJP03DelayAudioProcessor& p)
-    : AudioProcessorEditor (&p), audioProcessor (p)
+    : AudioProcessorEditor (&p), audioProcessor (p), lastMeterUpdateMs(juce::Time::getMillisecondCounterHiRes())
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (CONTAINER_WIDTH, CONTAINER_HEIGHT);
+    setSize (CONTAINER_WIDTH + METER_PANEL_WIDTH, CONTAINER_HEIGHT + WAVEFORM_HEIGHT);
     
     /* LR Toggle */
     matchLRToggle.setBounds(10.25*UNIT_LENGTH_X, 2*UNIT_LENGTH_Y, 6*UNIT_LENGTH_X, 2*UNIT_LENGTH_Y);
@@ -126,12 +141,32 @@ ColemanJP03DelayAudioProcessorEditor::ColemanJP03DelayAudioProcessorEditor (Cole
     makeFcValLabel(14*UNIT_LENGTH_X, rightLowCutFcLabel, juce::Justification::bottomLeft);
     makeFcValLabel(20*UNIT_LENGTH_X, rightHighCutFcLabel, juce::Justification::bottomRight);
     
-    startTimer(20); // update GUI from parameters every 20 ms, useful for param automation and saving state
-
+    /* Meters */
+    makeMeters(CONTAINER_WIDTH, LevelFrame::input, "In");
+    makeMeters(CONTAINER_WIDTH + 2.25*UNIT_LENGTH_X, LevelFrame::feedback, "Fb");
+    makeMeters(CONTAINER_WIDTH + 4.5*UNIT_LENGTH_X, LevelFrame::output, "Out");
+    
+    /* Delay Lines */
+    waveformView.setBounds(1*UNIT_LENGTH_X, CONTAINER_HEIGHT,
+                           CONTAINER_WIDTH + METER_PANEL_WIDTH - 2*UNIT_LENGTH_X, WAVEFORM_HEIGHT - 1*UNIT_LENGTH_Y);
+    addAndMakeVisible(waveformView);
+    
+    audioProcessor.setMetering(true); // only measured while an editor is open
+    
+    // sliders follow parameter changes from the host (automation, loading state).
+    // Only the parameters with controls are listened to; the multi-tap ones are host-only
+    static_assert(matchLR < 32, "one dirty bit per parameter");
+    for (int i = 0; i <= matchLR; ++i)
+        audioProcessor.getParameters().getUnchecked(i)->addListener(this);
+    startTimerHz(EDITOR_REFRESH_HZ);
 }
 
 ColemanJP03DelayAudioProcessorEditor::~ColemanJP03DelayAudioProcessorEditor()
 {
+    stopTimer();
+    for (int i = 0; i <= matchLR; ++i)
+        audioProcessor.getParameters().getUnchecked(i)->removeListener(this);
+    audioProcessor.setMetering(false);
 }
 
 /* Functions to avoid repetitive code in setting sliders and params from each other */
@@ -246,20 +281,109 @@ void ColemanJP03DelayAudioProcessorEditor::sliderValueChanged(juce::Slider *slid
     }
 }
 
-// Set sliders from paramter changes
+// can be called from any thread, so only marks the parameter for the next timer tick
+void ColemanJP03DelayAudioProcessorEditor::parameterValueChanged(int parameterIndex, float newValue) {
+    dirtyParams.fetch_or(1u << parameterIndex, std::memory_order_release);
+}
+
+void ColemanJP03DelayAudioProcessorEditor::parameterGestureChanged(int parameterIndex, bool gestureIsStarting) {
+    
+}
+
 void ColemanJP03DelayAudioProcessorEditor::timerCallback() {
+    syncFromProcessor();
+}
+
+// Runs on every timer tick, and only does work for what changed since the last one
+void ColemanJP03DelayAudioProcessorEditor::syncFromProcessor() {
+    uint32_t dirty = dirtyParams.exchange(0, std::memory_order_acquire);
+    if (dirty != 0)
+        updateFromParams(dirty);
+    
+    updateMeters();
+    updateWaveform();
+}
+
+// Set sliders from paramter changes
+void ColemanJP03DelayAudioProcessorEditor::updateFromParams(uint32_t dirty) {
     auto& params = processor.getParameters();
+    auto changed = [dirty](parameterMap paramNum) { return (dirty & (1u << paramNum)) != 0; };
     
-    setSliderFromParam(leftDelaySlider, leftDelayMs, params);
-    setSliderFromParam(rightDelaySlider, rightDelayMs, params);
-    setSliderFromParam(leftFeedbackSlider, leftFeedback, params);
-    setSliderFromParam(rightFeedbackSlider, rightFeedback, params);
+    if (changed(leftDelayMs))
+        setSliderFromParam(leftDelaySlider, leftDelayMs, params);
+    if (changed(rightDelayMs))
+        setSliderFromParam(rightDelaySlider, rightDelayMs, params);
+    if (changed(leftFeedback))
+        setSliderFromParam(leftFeedbackSlider, leftFeedback, params);
+    if (changed(rightFeedback))
+        setSliderFromParam(rightFeedbackSlider, rightFeedback, params);
     
-    setFilterSliderFromParam(leftFilterSlider, leftHighPassFc, leftLowPassFc, params);
-    setFilterSliderFromParam(rightFilterSlider, rightHighPassFc, rightLowPassFc, params);
+    if (changed(leftHighPassFc) || changed(leftLowPassFc))
+        setFilterSliderFromParam(leftFilterSlider, leftHighPassFc, leftLowPassFc, params);
+    if (changed(rightHighPassFc) || changed(rightLowPassFc))
+        setFilterSliderFromParam(rightFilterSlider, rightHighPassFc, rightLowPassFc, params);
     
-    setSliderFromParam(leftWetDrySlider, leftDryWet, params);
-    setSliderFromParam(rightWetDrySlider, rightDryWet, params);
+    if (changed(leftDryWet))
+        setSliderFromParam(leftWetDrySlider, leftDryWet, params);
+    if (changed(rightDryWet))
+        setSliderFromParam(rightWetDrySlider, rightDryWet, params);
+    
+    if (changed(leftDelayMs) || changed(rightDelayMs) || changed(leftFeedback) || changed(rightFeedback))
+        updateEchoes(params);
+}
+
+// folds every block queued since the last update into one reading per meter
+void ColemanJP03DelayAudioProcessorEditor::updateMeters() {
+    LevelFrame levels {};
+    LevelFrame block;
+    bool received = false;
+    while (audioProcessor.popLevels(block)) {
+        levels.add(block);
+        received = true;
+    }
+    
+    double now = juce::Time::getMillisecondCounterHiRes();
+    float secondsElapsed = (now - lastMeterUpdateMs)/1000.0;
+    lastMeterUpdateMs = now;
+    
+    // with no blocks (e.g. the host stopped) the meters fall back on their own,
+    // and once they are all at the bottom there is nothing left to do
+    if (! received) {
+        bool resting = true;
+        for (auto& pointMeters : meters)
+            for (auto& meter : pointMeters)
+                resting = resting && meter.isResting();
+        if (resting)
+            return;
+    }
+    
+    for (int point = 0; point < LevelFrame::numPoints; point++)
+        for (int ch = 0; ch < LevelFrame::numChannels; ch++)
+            meters[point][ch].setLevels(levels.peak[point][ch],
+                                        levels.rms((LevelFrame::Point) point, ch), secondsElapsed);
+}
+
+// hands the queued waveform bins to the view
+void ColemanJP03DelayAudioProcessorEditor::updateWaveform() {
+    WaveformBin bins[64];
+    int numBins;
+    do {
+        numBins = 0;
+        while (numBins < 64 && audioProcessor.popWaveformBin(bins[numBins]))
+            numBins++;
+        if (numBins > 0)
+            waveformView.addBins(bins, numBins);
+    } while (numBins == 64);
+}
+
+// moves the echo markers with the delay and feedback parameters
+void ColemanJP03DelayAudioProcessorEditor::updateEchoes(const juce::Array<juce::AudioProcessorParameter *> &parameters) {
+    auto get = [&parameters](parameterMap paramNum) {
+        return ((juce::AudioParameterFloat*)parameters.getUnchecked(paramNum))->get();
+    };
+    float delayMs[2] = { get(leftDelayMs), get(rightDelayMs) };
+    float feedbackGains[2] = { determineFeedbackGain(get(leftFeedback)), determineFeedbackGain(get(rightFeedback)) };
+    waveformView.setEchoes(delayMs, feedbackGains);
 }
 
 // match right side to left when matchLR is toggled
@@ -299,6 +423,9 @@ void ColemanJP03DelayAudioProcessorEditor::paint (juce::Graphics& g)
     // dry/wet
     g.drawLine(10*UNIT_LENGTH_X, 19.5*UNIT_LENGTH_Y, 8*UNIT_LENGTH_X, 19.5*UNIT_LENGTH_Y, 2.0f); // left
     g.drawLine(14*UNIT_LENGTH_X, 19.5*UNIT_LENGTH_Y, 16*UNIT_LENGTH_X, 19.5*UNIT_LENGTH_Y, 2.0f); // right
+    // meter panel
+    g.drawLine(CONTAINER_WIDTH - 0.25*UNIT_LENGTH_X, 1*UNIT_LENGTH_Y,
+               CONTAINER_WIDTH - 0.25*UNIT_LENGTH_X, 22*UNIT_LENGTH_Y, 2.0f);
 
     // filter labels
     g.setColour(juce::Colours::white);
@@ -10,10 +10,13 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "LevelMeter.h"
+#include "WaveformView.h"
 #include "Mu45FilterCalc/Mu45FilterCalc.h"
 #include "StkLite-4.6.1/Delay.h"
 #include "StkLite-4.6.1/BiQuad.h"
 #include "Defines.h"
+#include <atomic>
 
 
 //==============================================================================
@@ -21,7 +24,7 @@
 */
 class ColemanJP03DelayAudioProcessorEditor  : public juce::AudioProcessorEditor,
 public juce::Slider::Listener, public juce::Button::Listener,
-public juce::Timer
+public juce::AudioProcessorParameter::Listener, public juce::Timer
 {
 public:
     ColemanJP03DelayAudioProcessorEditor (ColemanJP03DelayAudioProcessor&);
@@ -34,6 +37,8 @@ public:
     void sliderValueChanged(juce::Slider* slider) override;
     void buttonStateChanged(juce::Button* button) override;
     void buttonClicked(juce::Button* button) override;
+    void parameterValueChanged(int parameterIndex, float newValue) override;
+    void parameterGestureChanged(int parameterIndex, bool gestureIsStarting) override;
     void timerCallback() override;
 
 private:
@@ -69,6 +74,13 @@ private:
     juce::Label rightLowCutFcLabel;
     juce::Label rightHighCutFcLabel;
     
+    /* Meters, [LevelFrame::Point][channel] */
+    LevelMeter meters[LevelFrame::numPoints][LevelFrame::numChannels];
+    juce::Label meterLabels[LevelFrame::numPoints];
+    double lastMeterUpdateMs;
+    
+    WaveformView waveformView;
+    
     enum parameterMap {
         leftDelayMs,
         rightDelayMs,
@@ -90,10 +102,21 @@ private:
     void makeLRLabel(int x, juce::Label& label, std::string labelText);
     void makeCenterLabel(int y, juce::Label& label, std::string labelText);
     void makeFcValLabel(int x, juce::Label& label, juce::Justification justification);
+    void makeMeters(int x, LevelFrame::Point point, std::string labelText);
+    void syncFromProcessor();
+    void updateFromParams(uint32_t dirty);
+    void updateMeters();
+    void updateWaveform();
+    void updateEchoes(const juce::Array<juce::AudioProcessorParameter *> &parameters);
     void setParamFromSlider(juce::Slider& slider, parameterMap paramNum);
     void setParamFromFilterSlider(juce::Slider& slider, parameterMap lowFc, parameterMap highFc);
     void setSliderFromParam(juce::Slider& slider, parameterMap paramNum,
         const juce::Array<juce::AudioProcessorParameter *> &parameters);
     void setFilterSliderFromParam(juce::Slider& slider, parameterMap lowFc,
         parameterMap highFc, const juce::Array<juce::AudioProcessorParameter *> &parameters);
+    
+    /* Parameter sync: listeners (on whatever thread the change happens) set the parameter's
+       bit, and syncFromProcessor() picks the bits up on the next timer tick.
+       Everything starts dirty so the first tick sets up all the controls. */
+    std::atomic<uint32_t> dirtyParams { ~0u };
 };
@@ -7,7 +7,9 @@
 */
 
 #include "PluginProcessor.h"
-#include "PluginEditor.h"
+#if ! DELAY_HEADLESS
+ #include "PluginEditor.h"
+#endif
 
 //==============================================================================
 ColemanJP03DelayAudioProcessor::ColemanJP03DelayAudioProcessor()
@@ -80,10 +82,114 @@ ColemanJP03DelayAudioProcessor::ColemanJP03DelayAudioProcessor()
     addParameter(matchLRParam = new juce::AudioParameterBool("matchLR",
                                                              "Match L/R",
                                                              false));
+    
+    addParameter(multiTapParam = new juce::AudioParameterBool("multiTap",
+                                                              "Multi-Tap",
+                                                              MULTITAP_DEFAULT));
+    addParameter(numTapsParam = new juce::AudioParameterInt("numTaps",
+                                                            "Taps",
+                                                            1,
+                                                            MULTITAP_NUM_TAPS_MAX,
+                                                            MULTITAP_NUM_TAPS_DEFAULT));
+    for (int tap = 0; tap < MULTITAP_NUM_TAPS_MAX; ++tap)
+    {
+        juce::String id = "tap" + juce::String(tap + 1);
+        juce::String name = "Tap " + juce::String(tap + 1);
+        addParameter(tapTimeMsParams[tap] = new juce::AudioParameterFloat(id + "TimeMs",
+                                                name + " Time (ms)",
+                                                delayRange,
+                                                juce::jmin((tap + 1)*MULTITAP_SPACING_MS_DEFAULT,
+                                                           DELAY_LENGTH_MS_MAX)));
+        addParameter(tapGainParams[tap] = new juce::AudioParameterFloat(id + "Gain",
+                                                name + " Gain",
+                                                MULTITAP_GAIN_MIN,
+                                                MULTITAP_GAIN_MAX,
+                                                MULTITAP_GAIN_DEFAULT));
+        addParameter(tapPanParams[tap] = new juce::AudioParameterFloat(id + "Pan",
+                                                name + " Pan",
+                                                MULTITAP_PAN_MIN,
+                                                MULTITAP_PAN_MAX,
+                                                MULTITAP_PAN_DEFAULT));
+        // by default only the first tap repeats, so the default feedback can't run away
+        addParameter(tapFeedbackParams[tap] = new juce::AudioParameterBool(id + "Feedback",
+                                                name + " Feedback",
+                                                tap == 0));
+    }
+    
+    addParameter(crossFeedParam = new juce::AudioParameterFloat("crossFeed",
+                                            "Cross-Feed",
+                                            CROSS_FEED_MIN,
+                                            CROSS_FEED_MAX,
+                                            CROSS_FEED_DEFAULT));
+    addParameter(pingPongParam = new juce::AudioParameterBool("pingPong",
+                                                              "Ping-Pong",
+                                                              PING_PONG_DEFAULT));
+    
+    juce::StringArray noteValueNames;
+    for (const auto& noteValue : TempoSync::noteValues)
+        noteValueNames.add(noteValue.name);
+    addParameter(tempoSyncParam = new juce::AudioParameterBool("tempoSync",
+                                                               "Tempo Sync",
+                                                               TEMPO_SYNC_DEFAULT));
+    addParameter(leftNoteValueParam = new juce::AudioParameterChoice("leftNoteValue",
+                                            "Left Note Value",
+                                            noteValueNames,
+                                            TempoSync::defaultNoteValue));
+    addParameter(rightNoteValueParam = new juce::AudioParameterChoice("rightNoteValue",
+                                            "Right Note Value",
+                                            noteValueNames,
+                                            TempoSync::defaultNoteValue));
+    
+    addParameter(modRateParam = new juce::AudioParameterFloat("modRate",
+                                            "Mod Rate (Hz)",
+                                            juce::NormalisableRange<float>(MOD_RATE_HZ_MIN, MOD_RATE_HZ_MAX,
+                                                                           0, MOD_RATE_HZ_SKEW),
+                                            MOD_RATE_HZ_DEFAULT));
+    addParameter(modDepthParam = new juce::AudioParameterFloat("modDepth",
+                                            "Mod Depth (ms)",
+                                            juce::NormalisableRange<float>(MOD_DEPTH_MS_MIN, MOD_DEPTH_MS_MAX,
+                                                                           MOD_DEPTH_MS_INTERVAL),
+                                            MOD_DEPTH_MS_DEFAULT));
+    addParameter(modWaveformParam = new juce::AudioParameterChoice("modWaveform",
+                                            "Mod Waveform",
+                                            juce::StringArray { "Sine", "Triangle" },
+                                            Lfo::sine));
+    
+    // adds latency, which is reported to the host
+    addParameter(oversamplingParam = new juce::AudioParameterChoice("oversampling",
+                                            "Oversampling",
+                                            juce::StringArray { "Off", "2x", "4x" },
+                                            OVERSAMPLING_DEFAULT));
+    
+    addParameter(saturationParam = new juce::AudioParameterBool("saturation",
+                                                                "Saturation",
+                                                                SATURATION_DEFAULT));
+    addParameter(saturationDriveParam = new juce::AudioParameterFloat("saturationDrive",
+                                            "Saturation Drive (dB)",
+                                            SATURATION_DRIVE_DB_MIN,
+                                            SATURATION_DRIVE_DB_MAX,
+                                            SATURATION_DRIVE_DB_DEFAULT));
+    
+    // the IDs live as long as the parameters, so the state code can use them without copying
+    jassert(getParameters().size() == numParams);
+    for (int i = 0; i < numParams; ++i)
+    {
+        auto* param = (juce::RangedAudioParameter*) getParameters().getUnchecked(i);
+        jassert(param->paramID.length() < PluginState::idLength);
+        paramIds[i] = param->paramID.toRawUTF8();
+    }
+    
+    fs = hostFs = 44100;
+    maxBlockSize = 0;
+    oversampling = 1;
+    hostBpm = TEMPO_BPM_DEFAULT;
+    invalidateParamCache();
+    startTimerHz(LATENCY_CHECK_HZ);
 }
 
 ColemanJP03DelayAudioProcessor::~ColemanJP03DelayAudioProcessor()
 {
+    stopTimer();
 }
 
 //==============================================================================
@@ -121,7 +227,8 @@ bool ColemanJP03DelayAudioProcessor::isMidiEffect() const
 
 double ColemanJP03DelayAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    // until the repeats fade below SILENCE_THRESHOLD_DB, kept up to date by calcAlgorithmParams()
+    return tailSeconds.load(std::memory_order_relaxed);
 }
 
 int ColemanJP03DelayAudioProcessor::getNumPrograms()
@@ -153,11 +260,30 @@ void ColemanJP03DelayAudioProcessor::prepareToPlay (double sampleRate, int sampl
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
-    fs = sampleRate;
-    
-    unsigned long samps = calcDelaySampsFromMs(DELAY_LENGTH_MS_MAX);
-    leftDelay.setMaximumDelay(samps);
-    rightDelay.setMaximumDelay(samps);
+    hostFs = sampleRate;
+    maxBlockSize = samplesPerBlock;
+    prepareEngine();
+    latencyChanged.store(false); // reported here already
+    setLatencySamples(latencySamples.load());
+}
+
+// sets the engine up for the host rate and the oversampling choice. Also called from
+// processBlock(), so it leaves reporting the new latency to the caller
+void ColemanJP03DelayAudioProcessor::prepareEngine()
+{
+    oversampling = 1 << oversamplingParam->getIndex();
+    delayEngine.prepare(hostFs, maxBlockSize, oversampling); // memory is reserved up front, this doesn't allocate
+    fs = hostFs*delayEngine.getOversampling();
+    latencySamples.store(delayEngine.getLatencySamples());
+    invalidateParamCache(); // filter coefficients and delay lengths depend on fs
+    calcAlgorithmParams(); // so the tail length is known before the first block
+}
+
+// on the message thread: reports the latency after processBlock() switched the oversampling
+void ColemanJP03DelayAudioProcessor::timerCallback()
+{
+    if (latencyChanged.exchange(false))
+        setLatencySamples(latencySamples.load());
 }
 
 unsigned long ColemanJP03DelayAudioProcessor::calcDelaySampsFromMs(float ms) {
@@ -198,64 +324,141 @@ bool ColemanJP03DelayAudioProcessor::isBusesLayoutSupported (const BusesLayout&
 #endif
 
 
-// convert percentage to gain for feedback (using dB scale)
-float determineFeedbackGain(float percent) {
-    if (percent == 0)
-        return 0;
-    float scaled_val = (100-percent)/5.0;
-    return pow(10, -scaled_val/20.0);
+// true if value is not the lastValue recorded, and records the new value
+static bool valueChanged(float value, float& lastValue) {
+    if (value == lastValue)
+        return false;
+    lastValue = value;
+    return true;
+}
+
+// true if the parameter moved since lastValue was recorded, and records the new value
+static bool paramChanged(juce::AudioParameterFloat* param, float& lastValue) {
+    return valueChanged(param->get(), lastValue);
+}
+
+// forces every parameter to be recomputed on the next block (e.g. after a sample rate change)
+void ColemanJP03DelayAudioProcessor::invalidateParamCache() {
+    for (float& lastValue : lastParamValues)
+        lastValue = std::numeric_limits<float>::quiet_NaN(); // NaN never compares equal
+    for (auto& tapValues : lastTapValues)
+        for (float& lastValue : tapValues)
+            lastValue = std::numeric_limits<float>::quiet_NaN();
 }
 
+// only recomputes coefficients and gains for parameters that changed since the last block
 void ColemanJP03DelayAudioProcessor::calcAlgorithmParams() {
     /* Filters */
-    float coeffsHPL[5], coeffsLPL[5], coeffsHPR[5], coeffsLPR[5];
-    
-    Mu45FilterCalc::calcCoeffsHPF(coeffsHPL,
-                                  leftHighPassFcParam->get(),
-                                  LOW_CUT_Q, fs);
-    leftHighPass.setCoefficients(coeffsHPL[0],coeffsHPL[1],
-                                 coeffsHPL[2],coeffsHPL[3],
-                                 coeffsHPL[4]);
-    
-    Mu45FilterCalc::calcCoeffsLPF(coeffsLPL,
-                                  leftLowPassFcParam->get(),
-                                  HIGH_CUT_Q, fs);
-    leftLowPass.setCoefficients(coeffsLPL[0],coeffsLPL[1],
-                                coeffsLPL[2],coeffsLPL[3],
-                                coeffsLPL[4]);
-    
-    Mu45FilterCalc::calcCoeffsHPF(coeffsHPR,
-                                  rightHighPassFcParam->get(),
-                                  LOW_CUT_Q, fs);
-    rightHighPass.setCoefficients(coeffsHPR[0],coeffsHPR[1],
-                                 coeffsHPR[2],coeffsHPR[3],
-                                 coeffsHPR[4]);
-    
-    Mu45FilterCalc::calcCoeffsLPF(coeffsLPR,
-                                  rightLowPassFcParam->get(),
-                                  HIGH_CUT_Q, fs);
-    rightLowPass.setCoefficients(coeffsLPR[0],coeffsLPR[1],
-                                coeffsLPR[2],coeffsLPR[3],
-                                coeffsLPR[4]);
+    float coeffs[5];
+    
+    if (paramChanged(leftHighPassFcParam, lastParamValues[leftHighPassFcIndex])) {
+        Mu45FilterCalc::calcCoeffsHPF(coeffs, leftHighPassFcParam->get(), LOW_CUT_Q, fs);
+        delayEngine.setHighPassCoeffs(0, coeffs);
+    }
+    
+    if (paramChanged(leftLowPassFcParam, lastParamValues[leftLowPassFcIndex])) {
+        Mu45FilterCalc::calcCoeffsLPF(coeffs, leftLowPassFcParam->get(), HIGH_CUT_Q, fs);
+        delayEngine.setLowPassCoeffs(0, coeffs);
+    }
+    
+    if (paramChanged(rightHighPassFcParam, lastParamValues[rightHighPassFcIndex])) {
+        Mu45FilterCalc::calcCoeffsHPF(coeffs, rightHighPassFcParam->get(), LOW_CUT_Q, fs);
+        delayEngine.setHighPassCoeffs(1, coeffs);
+    }
+    
+    if (paramChanged(rightLowPassFcParam, lastParamValues[rightLowPassFcIndex])) {
+        Mu45FilterCalc::calcCoeffsLPF(coeffs, rightLowPassFcParam->get(), HIGH_CUT_Q, fs);
+        delayEngine.setLowPassCoeffs(1, coeffs);
+    }
 
 
     /* Wet/Dry */
-    leftWetGain = leftDryWetParam->get()/100.0;
-    leftDryGain = 1 - leftDryWetParam->get()/100.0;
-    rightWetGain = rightDryWetParam->get()/100.0;
-    rightDryGain = 1 - rightDryWetParam->get()/100.0;
+    if (paramChanged(leftDryWetParam, lastParamValues[leftDryWetIndex]))
+        delayEngine.setWetDryGains(0, leftDryWetParam->get()/100.0,
+                                   1 - leftDryWetParam->get()/100.0);
+    if (paramChanged(rightDryWetParam, lastParamValues[rightDryWetIndex]))
+        delayEngine.setWetDryGains(1, rightDryWetParam->get()/100.0,
+                                   1 - rightDryWetParam->get()/100.0);
 
     
     /* Delay Length */
-    leftDelay.setDelay(calcDelaySampsFromMs(leftDelayMsParam->get()));
-    rightDelay.setDelay(calcDelaySampsFromMs(rightDelayMsParam->get()));
+    // In sync mode the lengths are note values at the host tempo, only worked out again
+    // when the tempo or a note value changes. A tempo ramp becomes a run of small delay
+    // changes, each crossfaded by the engine like any other delay time change.
+    const bool sync = tempoSyncParam->get();
+    bool tempoChanged = valueChanged(sync, lastParamValues[tempoSyncIndex]);
+    if (sync)
+        tempoChanged |= valueChanged(hostBpm, lastParamValues[hostBpmIndex]);
+    
+    bool leftDelayChanged = paramChanged(leftDelayMsParam, lastParamValues[leftDelayMsIndex]);
+    leftDelayChanged |= valueChanged(leftNoteValueParam->getIndex(), lastParamValues[leftNoteValueIndex]);
+    if (leftDelayChanged || tempoChanged)
+        delayEngine.setDelaySamps(0, calcDelaySampsFromMs(sync
+            ? TempoSync::noteMs(leftNoteValueParam->getIndex(), hostBpm) : leftDelayMsParam->get()));
+    
+    bool rightDelayChanged = paramChanged(rightDelayMsParam, lastParamValues[rightDelayMsIndex]);
+    rightDelayChanged |= valueChanged(rightNoteValueParam->getIndex(), lastParamValues[rightNoteValueIndex]);
+    if (rightDelayChanged || tempoChanged)
+        delayEngine.setDelaySamps(1, calcDelaySampsFromMs(sync
+            ? TempoSync::noteMs(rightNoteValueParam->getIndex(), hostBpm) : rightDelayMsParam->get()));
     
     /* Feedback */
     // use db scale under the hood
     // from 1 to 100 -> scaled from -20 to 0 dB loss
-    leftFeedbackGain = determineFeedbackGain(leftFeedbackParam->get());
-    rightFeedbackGain = determineFeedbackGain(rightFeedbackParam->get());
+    if (paramChanged(leftFeedbackParam, lastParamValues[leftFeedbackIndex]))
+        delayEngine.setFeedbackGain(0, determineFeedbackGain(leftFeedbackParam->get()));
+    if (paramChanged(rightFeedbackParam, lastParamValues[rightFeedbackIndex]))
+        delayEngine.setFeedbackGain(1, determineFeedbackGain(rightFeedbackParam->get()));
+    
+    /* Cross-Feed and Ping-Pong */
+    if (paramChanged(crossFeedParam, lastParamValues[crossFeedIndex]))
+        delayEngine.setCrossFeed(crossFeedParam->get()/100.0);
+    if (valueChanged(pingPongParam->get(), lastParamValues[pingPongIndex]))
+        delayEngine.setPingPong(pingPongParam->get());
+    
+    /* Modulation */
+    if (paramChanged(modRateParam, lastParamValues[modRateIndex]))
+        delayEngine.setModRate(modRateParam->get()/fs);
+    if (paramChanged(modDepthParam, lastParamValues[modDepthIndex]))
+        delayEngine.setModDepth(modDepthParam->get()*(fs/1000.0));
+    if (valueChanged(modWaveformParam->getIndex(), lastParamValues[modWaveformIndex]))
+        delayEngine.setModWaveform((Lfo::Waveform) modWaveformParam->getIndex());
+    
+    /* Saturation */
+    if (valueChanged(saturationParam->get(), lastParamValues[saturationIndex]))
+        delayEngine.setSaturation(saturationParam->get());
+    if (paramChanged(saturationDriveParam, lastParamValues[saturationDriveIndex]))
+        delayEngine.setSaturationDrive(std::pow(10, saturationDriveParam->get()/20.0));
+    
+    /* Multi-Tap */
+    // taps past the tap count are kept up to date at zero gain, so adding one fades it in
+    delayEngine.setMode(multiTapParam->get() ? DelayEngine::multiTap : DelayEngine::stereo);
+    for (int tap = 0; tap < MULTITAP_NUM_TAPS_MAX; tap++) {
+        float* lastValues = lastTapValues[tap];
+        const bool tapOn = tap < numTapsParam->get();
+        bool changed = paramChanged(tapTimeMsParams[tap], lastValues[tapTimeMsIndex]);
+        changed |= paramChanged(tapGainParams[tap], lastValues[tapGainIndex]);
+        changed |= paramChanged(tapPanParams[tap], lastValues[tapPanIndex]);
+        changed |= valueChanged(tapFeedbackParams[tap]->get(), lastValues[tapFeedbackIndex]);
+        changed |= valueChanged(tapOn, lastValues[tapOnIndex]);
+        if (changed)
+            delayEngine.setTap(tap, calcDelaySampsFromMs(tapTimeMsParams[tap]->get()),
+                               tapOn ? tapGainParams[tap]->get()/100.0 : 0,
+                               tapPanParams[tap]->get()/100.0,
+                               tapFeedbackParams[tap]->get());
+    }
+    
+    /* Tail, from the delay times and feedback just set */
+    tailSeconds.store(delayEngine.getTailSamples()/fs, std::memory_order_relaxed);
+}
 
+// keeps the last tempo the host reported, for hosts (or moments) without one
+void ColemanJP03DelayAudioProcessor::updateHostTempo()
+{
+    juce::AudioPlayHead::CurrentPositionInfo position;
+    if (auto* playHead = getPlayHead())
+        if (playHead->getCurrentPosition(position) && position.bpm > 0)
+            hostBpm = position.bpm;
 }
 
 void ColemanJP03DelayAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
@@ -273,85 +476,132 @@ void ColemanJP03DelayAudioProcessor::processBlock (juce::AudioBuffer<float>& buf
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
     
+    // switching clears the delay lines, like a mode change. The host hears about the
+    // new latency from timerCallback(), since setLatencySamples() can call back into it
+    if ((1 << oversamplingParam->getIndex()) != oversampling) {
+        prepareEngine();
+        latencyChanged.store(true);
+    }
+    
+    updateHostTempo();
     calcAlgorithmParams();
     
-    auto* leftChannelData = buffer.getWritePointer(0);
-    auto* rightChannelData = buffer.getWritePointer(1);
-    
-    for (int samp = 0; samp < buffer.getNumSamples(); samp ++) {
-        
-        float leftFeedbackDelayInput = leftDelay.nextOut();
-        leftFeedbackDelayInput *= leftFeedbackGain;
-        leftFeedbackDelayInput = leftLowPass.tick(leftFeedbackDelayInput);
-        leftFeedbackDelayInput = leftHighPass.tick(leftFeedbackDelayInput);
-        leftDelay.tick(leftChannelData[samp] + leftFeedbackDelayInput);
-        
-        leftChannelData[samp] = leftDryGain*leftChannelData[samp] + leftFeedbackGain*leftWetGain*leftDelay.nextOut();
-        
-        float rightFeedbackDelayInput = rightDelay.nextOut();
-        rightFeedbackDelayInput *= rightFeedbackGain;
-        rightFeedbackDelayInput = rightLowPass.tick(rightFeedbackDelayInput);
-        rightFeedbackDelayInput = rightHighPass.tick(rightFeedbackDelayInput);
-        rightDelay.tick(rightChannelData[samp] + rightFeedbackDelayInput);
-
-        rightChannelData[samp] = rightDryGain*rightChannelData[samp] + rightFeedbackGain*rightWetGain*rightDelay.nextOut();
+    const bool metering = meteringEnabled.load(std::memory_order_relaxed);
+    delayEngine.setMetering(metering);
+    
+    // whole-buffer processing, see DelayEngine for how the feedback loop is split into stages
+    delayEngine.process(buffer.getArrayOfWritePointers(), buffer.getNumSamples());
+    
+    // if the editor has fallen behind and the queue is full, the levels keep
+    // accumulating in the engine and go out with a later block instead
+    if (metering && levelFifo.push(delayEngine.getLevels()))
+        delayEngine.resetLevels();
+}
+
+//==============================================================================
+void ColemanJP03DelayAudioProcessor::setMetering(bool enabled)
+{
+    if (enabled) {
+        // drop whatever was left from the last editor
+        levelFifo.clear();
+        delayEngine.clearWaveformBins();
     }
+    meteringEnabled.store(enabled, std::memory_order_relaxed);
+}
+
+bool ColemanJP03DelayAudioProcessor::popLevels(LevelFrame& frame)
+{
+    return levelFifo.pop(frame);
+}
+
+bool ColemanJP03DelayAudioProcessor::popWaveformBin(WaveformBin& bin)
+{
+    return delayEngine.popWaveformBin(bin);
 }
 
 //==============================================================================
+// DELAY_HEADLESS builds the processor without the editor's sources, for DelayRender
 bool ColemanJP03DelayAudioProcessor::hasEditor() const
 {
+   #if DELAY_HEADLESS
+    return false;
+   #else
     return true; // (change this to false if you choose to not supply an editor)
+   #endif
 }
 
 juce::AudioProcessorEditor* ColemanJP03DelayAudioProcessor::createEditor()
 {
+   #if DELAY_HEADLESS
+    return nullptr;
+   #else
     return new ColemanJP03DelayAudioProcessorEditor (*this);
+   #endif
 }
 
 //==============================================================================
-// saves the current state of the float parameters
+// saves every parameter (matchLR included) as a binary chunk keyed by parameter ID, see PluginState.h
 void ColemanJP03DelayAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
-    DBG("-- SAVING STATE INFO --");
-    juce::XmlElement xml ("Parameters");
-    for (int i = 0; i < getParameters().size() - 1; ++i) // - 1 to ignore matchLRParam (an AudioParameterBool)
+    float values[numParams];
+    for (int i = 0; i < numParams; ++i)
     {
-        juce::AudioParameterFloat* param = (juce::AudioParameterFloat*)getParameters().getUnchecked(i);
-        juce::XmlElement* paramElement = new juce::XmlElement ("parameter" + juce::String(std::to_string(i)));
-        paramElement->setAttribute ("value", param->get());
-        xml.addChildElement (paramElement);
+        auto* param = (juce::RangedAudioParameter*) getParameters().getUnchecked(i);
+        values[i] = param->convertFrom0to1(param->getValue());
     }
-
-    DBG(xml.toString());
-    copyXmlToBinary (xml, destData);
+    
+    destData.setSize(PluginState::sizeFor(numParams));
+    PluginState::write(destData.getData(), paramIds, values, numParams);
 }
 
-// sets the state based on previously saved XML.
-// when the plugin loads for the first time, the defaults will get saved into XML
-// and then read buy this function to set the GUI
+// sets the state from a binary chunk, or from the XML that older versions saved.
+// parameters missing from the state keep their current values
 void ColemanJP03DelayAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    if (! PluginState::isBinaryState(data, sizeInBytes))
+    {
+        setStateFromXml(data, sizeInBytes);
+        return;
+    }
+    
+    float values[numParams];
+    bool found[numParams];
+    if (! PluginState::read(data, sizeInBytes, paramIds, values, found, numParams))
+        return;
+    
+    for (int i = 0; i < numParams; ++i)
+    {
+        auto* param = (juce::RangedAudioParameter*) getParameters().getUnchecked(i);
+        if (found[i] && std::isfinite(values[i]))
+            param->setValueNotifyingHost(param->convertTo0to1(values[i]));
+    }
+}
+
+// reads the XML state saved before the binary format: "parameterN" elements holding
+// the values of the first ten (float) parameters, by index
+void ColemanJP03DelayAudioProcessor::setStateFromXml (const void* data, int sizeInBytes)
+{
     DBG("-- READING SAVED STATE --");
     std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
+    if (xmlState == nullptr)
+        return;
     DBG(xmlState->toString());
     
     if (xmlState->hasTagName ("Parameters")) // read Parameters tag
     {
+        const int numXmlParams = 10; // matchLR and everything added after it were never saved
         juce::AudioParameterFloat* param;
         for (auto* element : xmlState->getChildIterator()) // loop through the saved parameter values and update them
         {
-            int paramNum = std::stoi(element->getTagName().substring(9).toStdString()); // chops off beginnging "parameter"
+            if (! element->getTagName().startsWith("parameter"))
+                continue;
+            int paramNum = element->getTagName().substring(9).getIntValue(); // chops off beginnging "parameter"
+            if (paramNum < 0 || paramNum >= numXmlParams)
+                continue;
             param = (juce::AudioParameterFloat*) getParameters().getUnchecked(paramNum);
             *param = element->getDoubleAttribute("value"); // set parameter value
         }
     }
-
 }
 
 //==============================================================================
@@ -10,14 +10,18 @@
 
 #include <JuceHeader.h>
 #include "Mu45FilterCalc/Mu45FilterCalc.h"
-#include "StkLite-4.6.1/Delay.h"
-#include "StkLite-4.6.1/BiQuad.h"
+#include "DelayEngine.h"
+#include "FeedbackGain.h"
+#include "SpscFifo.h"
+#include "PluginState.h"
+#include "TempoSync.h"
 #include "Defines.h"
 
 //==============================================================================
 /**
 */
-class ColemanJP03DelayAudioProcessor  : public juce::AudioProcessor
+class ColemanJP03DelayAudioProcessor  : public juce::AudioProcessor,
+                                        private juce::Timer
 {
 public:
     //==============================================================================
@@ -57,6 +61,14 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    //==============================================================================
+    /* Level and waveform telemetry for the editor, called from the message thread only.
+       While metering is on, processBlock() queues one LevelFrame per block, and the
+       engine queues waveform bins as they fill up. */
+    void setMetering(bool enabled);
+    bool popLevels(LevelFrame& frame);
+    bool popWaveformBin(WaveformBin& bin);
+
 private:
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ColemanJP03DelayAudioProcessor)
@@ -78,23 +90,106 @@ private:
     
     juce::AudioParameterBool* matchLRParam;
     
+    /* Multi-tap mode, host parameters only (the editor shows the stereo controls) */
+    juce::AudioParameterBool* multiTapParam;
+    juce::AudioParameterInt* numTapsParam;
+    juce::AudioParameterFloat* tapTimeMsParams[MULTITAP_NUM_TAPS_MAX];
+    juce::AudioParameterFloat* tapGainParams[MULTITAP_NUM_TAPS_MAX];
+    juce::AudioParameterFloat* tapPanParams[MULTITAP_NUM_TAPS_MAX];
+    juce::AudioParameterBool* tapFeedbackParams[MULTITAP_NUM_TAPS_MAX];
+    
+    /* Stereo feedback matrix, host parameters only too */
+    juce::AudioParameterFloat* crossFeedParam;
+    juce::AudioParameterBool* pingPongParam;
+    
+    /* Tempo sync, host parameters only too: in sync mode the delay times are note values */
+    juce::AudioParameterBool* tempoSyncParam;
+    juce::AudioParameterChoice* leftNoteValueParam;
+    juce::AudioParameterChoice* rightNoteValueParam;
+    
+    /* Delay time modulation, host parameters only too */
+    juce::AudioParameterFloat* modRateParam;
+    juce::AudioParameterFloat* modDepthParam;
+    juce::AudioParameterChoice* modWaveformParam;
+    
+    /* Oversampling of the whole engine, host parameter only too */
+    juce::AudioParameterChoice* oversamplingParam;
+    
+    /* Feedback saturation, host parameters only too */
+    juce::AudioParameterBool* saturationParam;
+    juce::AudioParameterFloat* saturationDriveParam;
+    
+    /* Parameter IDs in getParameters() order, for the binary state chunk */
+    static constexpr int numParams = 24 + 4*MULTITAP_NUM_TAPS_MAX;
+    const char* paramIds[numParams];
+    
+    void setStateFromXml(const void* data, int sizeInBytes);
+    
     /* Algorithm Params, Filters, and Delays*/
-    stk::Delay leftDelay;
-    stk::Delay rightDelay;
-
-    stk::BiQuad leftHighPass;
-    stk::BiQuad leftLowPass;
-    stk::BiQuad rightHighPass;
-    stk::BiQuad rightLowPass;
-    
-    float fs;
-    float leftWetGain;
-    float leftDryGain;
-    float rightWetGain;
-    float rightDryGain;
-    float leftFeedbackGain;
-    float rightFeedbackGain;
+    DelayEngine delayEngine; // left = channel 0, right = channel 1
+    
+    float fs; // the engine's rate: the host's times the oversampling factor
+    float hostFs;
+    int maxBlockSize;
+    int oversampling; // the factor the engine was prepared for, before any capping
+    double hostBpm; // from the play head, kept from the last block that had one
+    
+    void updateHostTempo();
+    void prepareEngine();
+    
+    /* Latency of the engine as last prepared. An oversampling change in processBlock()
+       only raises latencyChanged; timerCallback() reports it to the host from the
+       message thread, so the audio thread never posts messages or waits on the host */
+    std::atomic<int> latencySamples { 0 };
+    std::atomic<bool> latencyChanged { false };
+    void timerCallback() override;
+    
+    /* Metering: the editor switches it on, the audio thread fills the queue */
+    std::atomic<bool> meteringEnabled { false };
+    SpscFifo<LevelFrame, LEVEL_FIFO_SIZE> levelFifo;
+    
+    /* Set by the audio thread, read by getTailLengthSeconds() from any thread */
+    std::atomic<double> tailSeconds { 0 };
+    
+    /* Parameter values the current coefficients and gains were computed from,
+       so calcAlgorithmParams() only redoes the work for parameters that moved */
+    enum paramCacheIndex {
+        leftDelayMsIndex,
+        rightDelayMsIndex,
+        leftFeedbackIndex,
+        rightFeedbackIndex,
+        leftDryWetIndex,
+        rightDryWetIndex,
+        leftHighPassFcIndex,
+        rightHighPassFcIndex,
+        leftLowPassFcIndex,
+        rightLowPassFcIndex,
+        crossFeedIndex,
+        pingPongIndex,
+        tempoSyncIndex,
+        hostBpmIndex,
+        leftNoteValueIndex,
+        rightNoteValueIndex,
+        modRateIndex,
+        modDepthIndex,
+        modWaveformIndex,
+        saturationIndex,
+        saturationDriveIndex,
+        numCachedParams
+    };
+    float lastParamValues[numCachedParams];
+    
+    enum tapCacheIndex {
+        tapTimeMsIndex,
+        tapGainIndex,
+        tapPanIndex,
+        tapFeedbackIndex,
+        tapOnIndex, // within the tap count
+        numCachedTapParams
+    };
+    float lastTapValues[MULTITAP_NUM_TAPS_MAX][numCachedTapParams];
     
+    void invalidateParamCache();
     void calcAlgorithmParams();
     unsigned long calcDelaySampsFromMs(float ms);
 };
@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    PluginState.cpp
+
+  ==============================================================================
+*/
+
+#include "PluginState.h"
+#include <cstring>
+
+static const uint8_t magic[4] = { 'M', 'D', 'L', 'Y' };
+
+/* Byte order helpers, so the chunk is the same on every platform */
+static void writeUint16(uint8_t* p, uint16_t x) {
+    p[0] = (uint8_t) x;
+    p[1] = (uint8_t) (x >> 8);
+}
+
+static uint16_t readUint16(const uint8_t* p) {
+    return (uint16_t) (p[0] | (p[1] << 8));
+}
+
+static void writeFloat(uint8_t* p, float value) {
+    uint32_t x;
+    std::memcpy(&x, &value, 4);
+    for (int i = 0; i < 4; i++)
+        p[i] = (uint8_t) (x >> (8*i));
+}
+
+static float readFloat(const uint8_t* p) {
+    uint32_t x = (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+    float value;
+    std::memcpy(&value, &x, 4);
+    return value;
+}
+
+bool PluginState::isBinaryState(const void* data, int size) {
+    return data != nullptr && size >= (int) sizeof(magic) && std::memcmp(data, magic, sizeof(magic)) == 0;
+}
+
+void PluginState::write(void* dest, const char* const* ids, const float* values, int numParams) {
+    uint8_t* p = (uint8_t*) dest;
+    std::memcpy(p, magic, sizeof(magic));
+    writeUint16(p + 4, version);
+    writeUint16(p + 6, headerSize);
+    writeUint16(p + 8, entrySize);
+    writeUint16(p + 10, (uint16_t) numParams);
+
+    p += headerSize;
+    for (int i = 0; i < numParams; i++, p += entrySize) {
+        std::memset(p, 0, idLength);
+        std::strncpy((char*) p, ids[i], idLength - 1);
+        writeFloat(p + idLength, values[i]);
+    }
+}
+
+bool PluginState::read(const void* data, int size, const char* const* ids, float* values, bool* found,
+                       int numParams) {
+    if (! isBinaryState(data, size) || size < headerSize)
+        return false;
+
+    const uint8_t* p = (const uint8_t*) data;
+    const int storedHeaderSize = readUint16(p + 6);
+    const int storedEntrySize = readUint16(p + 8);
+    const int numEntries = readUint16(p + 10);
+    if (storedHeaderSize < headerSize || storedEntrySize < entrySize
+        || size < storedHeaderSize + numEntries*storedEntrySize)
+        return false;
+
+    for (int i = 0; i < numParams; i++)
+        found[i] = false;
+
+    // the first pass only checks, so a damaged chunk leaves the values alone
+    for (int pass = 0; pass < 2; pass++) {
+        const uint8_t* entry = p + storedHeaderSize;
+        for (int e = 0; e < numEntries; e++, entry += storedEntrySize) {
+            const char* id = (const char*) entry;
+            if (std::memchr(id, 0, idLength) == nullptr)
+                return false; // ID not terminated
+
+            if (pass == 1) {
+                // entries are normally in parameter order, so look there first
+                for (int n = 0; n < numParams; n++) {
+                    int i = (e + n) % numParams;
+                    if (std::strcmp(id, ids[i]) == 0) {
+                        values[i] = readFloat(entry + idLength);
+                        found[i] = true;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
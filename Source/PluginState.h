@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    PluginState.h
+
+    The binary state chunk getStateInformation() saves: a fixed-layout list
+    of parameter values keyed by parameter ID, readable without allocating.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstdint>
+
+/* Layout, all integers and floats little-endian:
+
+     offset 0   uint32  magic ('M' 'D' 'L' 'Y')
+            4   uint16  version
+            6   uint16  header size in bytes (12 in version 1)
+            8   uint16  entry size in bytes (28 in version 1)
+           10   uint16  number of entries
+           12   entries, each:
+                  char[24]  parameter ID, NUL padded (so at most 23 characters)
+                  float32   value, in the parameter's own units (ms, %, Hz, 0/1)
+
+   Later versions may only add fields to the end of the header or of each entry, and
+   readers skip what they don't know using the stored sizes. Entries are matched by
+   ID, so parameters can be added, removed or reordered without breaking old sessions:
+   parameters missing from a chunk keep their current values. */
+namespace PluginState
+{
+    constexpr int version = 1;
+    constexpr int headerSize = 12;
+    constexpr int idLength = 24;
+    constexpr int entrySize = idLength + 4;
+
+    // bytes write() needs for numParams parameters
+    constexpr int sizeFor(int numParams) { return headerSize + numParams*entrySize; }
+
+    // true if data starts with the magic number (of any version)
+    bool isBinaryState(const void* data, int size);
+
+    // Writes ids[i] = values[i] for every parameter into dest, which must hold
+    // sizeFor(numParams) bytes. IDs longer than idLength - 1 are cut short.
+    void write(void* dest, const char* const* ids, const float* values, int numParams);
+
+    // Sets values[i] and found[i] = true for every ids[i] in the chunk, and found[i] = false
+    // for the rest. Returns false, without setting any values, if the chunk is truncated or
+    // otherwise damaged.
+    bool read(const void* data, int size, const char* const* ids, float* values, bool* found, int numParams);
+}
@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    Saturator.cpp
+
+  ==============================================================================
+*/
+
+#include "Saturator.h"
+#include <cmath>
+
+#if defined(DELAY_NO_SIMD) // scalar loops only
+#elif defined(_STK_FLOAT32_) && (defined(__SSE__) || defined(_M_X64) || defined(_M_IX86_FP))
+ #include <xmmintrin.h>
+ #define SATURATOR_SSE 1
+#elif defined(_STK_FLOAT32_) && defined(__aarch64__)
+ #include <arm_neon.h>
+ #define SATURATOR_NEON 1 // vsqrtq_f32 and vdivq_f32 are AArch64 only
+#endif
+
+namespace {
+
+/* 4-lane vector wrappers so the kernels are only written once */
+#if SATURATOR_SSE
+struct Lanes
+{
+    __m128 v;
+
+    static Lanes load(const float* p) { return { _mm_loadu_ps(p) }; }
+    static Lanes set1(float x) { return { _mm_set1_ps(x) }; }
+    void store(float* p) const { _mm_storeu_ps(p, v); }
+
+    Lanes operator+(Lanes o) const { return { _mm_add_ps(v, o.v) }; }
+    Lanes operator*(Lanes o) const { return { _mm_mul_ps(v, o.v) }; }
+    Lanes operator/(Lanes o) const { return { _mm_div_ps(v, o.v) }; }
+    Lanes sqrt() const { return { _mm_sqrt_ps(v) }; }
+};
+#elif SATURATOR_NEON
+struct Lanes
+{
+    float32x4_t v;
+
+    static Lanes load(const float* p) { return { vld1q_f32(p) }; }
+    static Lanes set1(float x) { return { vdupq_n_f32(x) }; }
+    void store(float* p) const { vst1q_f32(p, v); }
+
+    Lanes operator+(Lanes o) const { return { vaddq_f32(v, o.v) }; }
+    Lanes operator*(Lanes o) const { return { vmulq_f32(v, o.v) }; }
+    Lanes operator/(Lanes o) const { return { vdivq_f32(v, o.v) }; }
+    Lanes sqrt() const { return { vsqrtq_f32(v) }; }
+};
+#endif
+
+}
+
+Saturator::Saturator(int maxBlockSize) {
+    driven.resize(maxBlockSize + 1, 1);
+    roots.resize(maxBlockSize + 1, 1);
+    reset();
+}
+
+void Saturator::reset() {
+    driven[0] = 0;
+    roots[0] = 1;
+}
+
+void Saturator::process(const stk::StkFloat* in, stk::StkFloat* out, int numSamples, stk::StkFloat drive) {
+    processDrive(in, out, numSamples, &drive, 0);
+}
+
+void Saturator::process(const stk::StkFloat* in, stk::StkFloat* out, int numSamples, const stk::StkFloat* drive) {
+    processDrive(in, out, numSamples, drive, 1);
+}
+
+void Saturator::processDrive(const stk::StkFloat* in, stk::StkFloat* out, int numSamples,
+                             const stk::StkFloat* drive, int driveStride) {
+    if (numSamples <= 0)
+        return;
+
+    // u[i] and S[i] of input i are at i + 1, after the previous block's last ones
+    stk::StkFloat* u = &driven[0];
+    stk::StkFloat* s = &roots[0];
+    if (driveStride == 0) {
+        const stk::StkFloat g = *drive;
+        for (int i = 0; i < numSamples; i++)
+            u[i + 1] = g*in[i];
+    }
+    else {
+        for (int i = 0; i < numSamples; i++)
+            u[i + 1] = drive[i]*in[i];
+    }
+
+    /* S = sqrt(1 + u^2) */
+    int i = 0;
+#if SATURATOR_SSE || SATURATOR_NEON
+    const Lanes one = Lanes::set1(1);
+    for (; i + 4 <= numSamples; i += 4) {
+        Lanes x = Lanes::load(u + i + 1);
+        (one + x*x).sqrt().store(s + i + 1);
+    }
+#endif
+    for (; i < numSamples; i++)
+        s[i + 1] = std::sqrt(1 + u[i + 1]*u[i + 1]);
+
+    /* out = (u[n] + u[n-1])/(drive (S[n] + S[n-1])), the antiderivative's slope scaled back */
+    i = 0;
+#if SATURATOR_SSE || SATURATOR_NEON
+    if (driveStride == 0) {
+        const Lanes g = Lanes::set1(*drive);
+        for (; i + 4 <= numSamples; i += 4) {
+            Lanes sum = Lanes::load(u + i + 1) + Lanes::load(u + i);
+            Lanes rootSum = Lanes::load(s + i + 1) + Lanes::load(s + i);
+            (sum/(g*rootSum)).store(out + i);
+        }
+    }
+    else {
+        for (; i + 4 <= numSamples; i += 4) {
+            Lanes sum = Lanes::load(u + i + 1) + Lanes::load(u + i);
+            Lanes rootSum = Lanes::load(s + i + 1) + Lanes::load(s + i);
+            (sum/(Lanes::load(drive + i)*rootSum)).store(out + i);
+        }
+    }
+#endif
+    for (; i < numSamples; i++)
+        out[i] = (u[i + 1] + u[i])/(drive[i*driveStride]*(s[i + 1] + s[i]));
+
+    driven[0] = u[numSamples];
+    roots[0] = s[numSamples];
+}
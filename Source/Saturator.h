@@ -0,0 +1,49 @@
+/*
+  ==============================================================================
+
+    Saturator.h
+
+    Soft clipping for one feedback loop, anti-aliased with its
+    antiderivative, a block at a time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "StkLite-4.6.1/Stk.h"
+
+/* The curve is f(u) = u/sqrt(1 + u^2), on u = drive*x and scaled back down by the drive, so
+   quiet signals pass at unity gain and nothing gets past +-1/drive: with this in the loop,
+   feedback at 100% levels off instead of running away.
+
+   Instead of f(u[n]) each output is the average of f between the last two inputs, the
+   difference of its antiderivative F(u) = sqrt(1 + u^2) over the difference of the inputs
+   (first-order antiderivative anti-aliasing). The harmonics that would fold back past
+   Nyquist come out much quieter, at the cost of half a sample of delay. For this curve the
+   quotient simplifies exactly to (u[n] + u[n-1])/(S[n] + S[n-1]), with S = sqrt(1 + u^2),
+   so it needs no special case for nearly equal inputs and no division by their difference.
+   That leaves a square root and a division per sample, which run four lanes at a time
+   (SSE, or NEON on AArch64) when StkFloat is a float. */
+class Saturator
+{
+public:
+    // maxBlockSize is the most samples per process() call
+    explicit Saturator(int maxBlockSize);
+
+    // forgets the previous input, e.g. when the saturation is switched back on
+    void reset();
+
+    // in and out may be the same. drive is at least 1, either one value or one per sample
+    void process(const stk::StkFloat* in, stk::StkFloat* out, int numSamples, stk::StkFloat drive);
+    void process(const stk::StkFloat* in, stk::StkFloat* out, int numSamples, const stk::StkFloat* drive);
+
+private:
+    // driveStride is 0 for a constant drive, 1 for one per sample
+    void processDrive(const stk::StkFloat* in, stk::StkFloat* out, int numSamples,
+                      const stk::StkFloat* drive, int driveStride);
+
+    // the driven input and its S, each with the last sample of the previous block in front
+    stk::StkFrames driven;
+    stk::StkFrames roots;
+};
@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    SpscFifo.h
+
+    Wait-free single-producer/single-consumer queue for passing small,
+    trivially copyable items from the audio thread to the GUI.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+/* One thread may push and one other thread may pop. Neither side ever blocks, loops or
+   allocates: push() fails when the queue is full and pop() fails when it is empty, each
+   after two atomic loads and at most one atomic store.
+
+   The indices run freely and are masked on use, so all capacity slots can be filled.
+   They sit on separate cache lines so the two threads don't keep taking the line from
+   each other. */
+template <typename T, int capacity>
+class SpscFifo
+{
+public:
+    static_assert(capacity > 0 && (capacity & (capacity - 1)) == 0, "capacity must be a power of two");
+    static_assert(std::is_trivially_copyable<T>::value, "items are copied in and out with plain stores");
+
+    // producer only: false if the queue is full (the item is not added)
+    bool push(const T& item) {
+        const uint32_t write = writeIndex.load(std::memory_order_relaxed);
+        if (write - readIndex.load(std::memory_order_acquire) == (uint32_t) capacity)
+            return false;
+        items[write & mask] = item;
+        writeIndex.store(write + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only: false if the queue is empty
+    bool pop(T& item) {
+        const uint32_t read = readIndex.load(std::memory_order_relaxed);
+        if (read == writeIndex.load(std::memory_order_acquire))
+            return false;
+        item = items[read & mask];
+        readIndex.store(read + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only: drops everything that is queued
+    void clear() {
+        readIndex.store(writeIndex.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    static constexpr uint32_t mask = capacity - 1;
+
+    T items[capacity];
+    alignas(64) std::atomic<uint32_t> writeIndex { 0 };
+    alignas(64) std::atomic<uint32_t> readIndex { 0 };
+};
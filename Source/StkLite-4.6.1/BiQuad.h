@@ -138,19 +138,30 @@ inline StkFrames& BiQuad :: tick( StkFrames& frames, unsigned int channel )
   }
 #endif
 
+  // Coefficients and state are kept in locals for the whole block so
+  // they aren't reloaded after every store to the sample buffer.
+  const StkFloat b0 = b_[0], b1 = b_[1], b2 = b_[2], a1 = a_[1], a2 = a_[2];
+  StkFloat x0 = inputs_[0], x1 = inputs_[1], x2 = inputs_[2];
+  StkFloat y1 = outputs_[1], y2 = outputs_[2];
+
   StkFloat *samples = &frames[channel];
   unsigned int hop = frames.channels();
   for ( unsigned int i=0; i<frames.frames(); i++, samples += hop ) {
-    inputs_[0] = gain_ * *samples;
-    *samples = b_[0] * inputs_[0] + b_[1] * inputs_[1] + b_[2] * inputs_[2];
-    *samples -= a_[2] * outputs_[2] + a_[1] * outputs_[1];
-    inputs_[2] = inputs_[1];
-    inputs_[1] = inputs_[0];
-    outputs_[2] = outputs_[1];
-    outputs_[1] = *samples;
+    x0 = gain_ * *samples;
+    *samples = b0 * x0 + b1 * x1 + b2 * x2;
+    *samples -= a2 * y2 + a1 * y1;
+    x2 = x1;
+    x1 = x0;
+    y2 = y1;
+    y1 = *samples;
   }
 
-  lastFrame_[0] = outputs_[1];
+  inputs_[0] = x0;
+  inputs_[1] = x1;
+  inputs_[2] = x2;
+  outputs_[1] = y1;
+  outputs_[2] = y2;
+  lastFrame_[0] = y1;
   return frames;
 }
 
@@ -163,20 +174,29 @@ inline StkFrames& BiQuad :: tick( StkFrames& iFrames, StkFrames& oFrames, unsign
   }
 #endif
 
+  const StkFloat b0 = b_[0], b1 = b_[1], b2 = b_[2], a1 = a_[1], a2 = a_[2];
+  StkFloat x0 = inputs_[0], x1 = inputs_[1], x2 = inputs_[2];
+  StkFloat y1 = outputs_[1], y2 = outputs_[2];
+
   StkFloat *iSamples = &iFrames[iChannel];
   StkFloat *oSamples = &oFrames[oChannel];
   unsigned int iHop = iFrames.channels(), oHop = oFrames.channels();
   for ( unsigned int i=0; i<iFrames.frames(); i++, iSamples += iHop, oSamples += oHop ) {
-    inputs_[0] = gain_ * *iSamples;
-    *oSamples = b_[0] * inputs_[0] + b_[1] * inputs_[1] + b_[2] * inputs_[2];
-    *oSamples -= a_[2] * outputs_[2] + a_[1] * outputs_[1];
-    inputs_[2] = inputs_[1];
-    inputs_[1] = inputs_[0];
-    outputs_[2] = outputs_[1];
-    outputs_[1] = *oSamples;
+    x0 = gain_ * *iSamples;
+    *oSamples = b0 * x0 + b1 * x1 + b2 * x2;
+    *oSamples -= a2 * y2 + a1 * y1;
+    x2 = x1;
+    x1 = x0;
+    y2 = y1;
+    y1 = *oSamples;
   }
 
-  lastFrame_[0] = outputs_[1];
+  inputs_[0] = x0;
+  inputs_[1] = x1;
+  inputs_[2] = x2;
+  outputs_[1] = y1;
+  outputs_[2] = y2;
+  lastFrame_[0] = y1;
   return iFrames;
 }
 
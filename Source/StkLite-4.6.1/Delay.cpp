@@ -28,10 +28,17 @@ Delay :: Delay( unsigned long delay, unsigned long maxDelay )
     handleError( StkError::FUNCTION_ARGUMENT );
   }
 
-  if ( ( maxDelay + 1 ) > inputs_.size() )
-    inputs_.resize( maxDelay + 1, 1, 0.0 );
+  allocate( maxDelay + 1 );
 
-  inPoint_ = 0;
+  fadeLength_ = 0;
+  fadePos_ = 0;
+  fadeOffset_ = 0;
+  fadeFromDelay_ = 0;
+  pendingDelay_ = 0;
+  hasPendingDelay_ = false;
+  fadeCurve_ = EQUAL_POWER;
+  nextFadeCurve_ = EQUAL_POWER;
+  fadeStep_ = 0.0;
   this->setDelay( delay );
 }
 
@@ -42,7 +49,8 @@ Delay :: ~Delay()
 void Delay :: setMaximumDelay( unsigned long delay )
 {
   if ( delay < inputs_.size() ) return;
-  inputs_.resize( delay + 1, 1, 0.0 );
+  endCrossfade();
+  allocate( delay + 1 );
 }
 
 void Delay :: setDelay( unsigned long delay )
@@ -52,12 +60,106 @@ void Delay :: setDelay( unsigned long delay )
     handleError( StkError::WARNING ); return;
   }
 
+  if ( fadeLength_ > 0 ) {
+    if ( isCrossfading() ) {
+      pendingDelay_ = delay;
+      hasPendingDelay_ = true;
+    }
+    else if ( delay != delay_ ) startCrossfade( delay );
+    return;
+  }
+
+  setReadPoint( delay );
+}
+
+void Delay :: setReadPoint( unsigned long delay )
+{
   // read chases write
-  if ( inPoint_ >= delay ) outPoint_ = inPoint_ - delay;
-  else outPoint_ = inputs_.size() + inPoint_ - delay;
+  outPoint_ = wrap( inPoint_ - delay );
   delay_ = delay;
 }
 
+void Delay :: setCrossfade( unsigned long samples, CrossfadeCurve curve )
+{
+  endCrossfade();
+  fadeLength_ = samples;
+  fadePos_ = samples;
+  fadeCurve_ = curve;
+  nextFadeCurve_ = curve;
+  fadeStep_ = samples > 0 ? 1.0 / samples : 0.0;
+}
+
+void Delay :: endCrossfade( void )
+{
+  fadePos_ = fadeLength_;
+  if ( hasPendingDelay_ ) setReadPoint( pendingDelay_ );
+  hasPendingDelay_ = false;
+}
+
+void Delay :: startCrossfade( unsigned long delay )
+{
+  fadeFromDelay_ = delay_;
+  fadeCurve_ = nextFadeCurve_;
+  fadeOffset_ = wrap( delay - delay_ );
+  fadePos_ = 0;
+  setReadPoint( delay );
+}
+
+void Delay :: stepCrossfade( unsigned long count )
+{
+  unsigned long left = fadeLength_ - fadePos_;
+  fadePos_ = std::min( fadePos_ + count, fadeLength_ );
+  if ( fadePos_ == fadeLength_ && hasPendingDelay_ ) {
+    hasPendingDelay_ = false;
+    if ( pendingDelay_ == delay_ ) return;
+
+    // The held change starts where this crossfade ended, which may be part way
+    // through a block (see readBlock()).
+    startCrossfade( pendingDelay_ );
+    fadePos_ = std::min( count - left, fadeLength_ );
+  }
+}
+
+void Delay :: crossfadeGains( unsigned long position, StkFloat &oldGain, StkFloat &newGain ) const
+{
+  StkFloat x = position * fadeStep_;
+  if ( fadeCurve_ == LINEAR ) {
+    oldGain = 1.0 - x;
+    newGain = x;
+    return;
+  }
+
+  equalPowerGains( x, oldGain, newGain );
+}
+
+StkFloat Delay :: crossfadeOut( unsigned long offset )
+{
+  unsigned long newPoint = wrap( outPoint_ + offset );
+  unsigned long oldPoint = wrap( newPoint + fadeOffset_ );
+
+  if ( fadeCurve_ == LINEAR ) { // same form as readBlock()
+    StkFloat x = ( fadePos_ + offset ) * fadeStep_;
+    return inputs_[oldPoint] + x * ( inputs_[newPoint] - inputs_[oldPoint] );
+  }
+
+  StkFloat oldGain, newGain;
+  crossfadeGains( fadePos_ + offset, oldGain, newGain );
+  return oldGain * inputs_[oldPoint] + newGain * inputs_[newPoint];
+}
+
+StkFloat Delay :: crossfadeTick( StkFloat input )
+{
+  inputs_[inPoint_] = input * gain_;
+  inPoint_ = wrap( inPoint_ + 1 );
+
+  lastFrame_[0] = crossfadeOut( 0 );
+
+  outPoint_ = wrap( outPoint_ + 1 );
+  stepCrossfade( 1 );
+
+  return lastFrame_[0];
+}
+
 StkFloat Delay :: energy( void ) const
 {
   unsigned long i;
@@ -80,31 +182,80 @@ StkFloat Delay :: energy( void ) const
   return e;
 }
 
-StkFloat Delay :: tapOut( unsigned long tapDelay )
+void Delay :: readBlock( StkFloat *out, unsigned long count, unsigned long offset )
 {
-  long tap = inPoint_ - tapDelay - 1;
-  while ( tap < 0 ) // Check for wraparound.
-    tap += inputs_.size();
+  StkFloat *data[2];
+  unsigned long sizes[2];
+  unsigned int nSpans = outSpans( count, data, sizes, offset );
+
+  StkFloat *dst = out;
+  for ( unsigned int s=0; s<nSpans; s++ ) {
+    std::memcpy( dst, data[s], sizes[s] * sizeof( StkFloat ) );
+    dst += sizes[s];
+  }
 
-  return inputs_[tap];
+  if ( !isCrossfading() ) return;
+
+  if ( fadePos_ + offset < fadeLength_ ) {
+    // Mix in the old read position for the part of the block still inside the crossfade.
+    unsigned long fadeCount = std::min( count, fadeLength_ - fadePos_ - offset );
+    unsigned long oldOffset = wrap( offset + fadeOffset_ );
+    nSpans = outSpans( fadeCount, data, sizes, oldOffset );
+
+    StkFloat *faded = out;
+    StkFloat x = ( fadePos_ + offset ) * fadeStep_;
+    for ( unsigned int s=0; s<nSpans; s++ ) {
+      int n = (int) sizes[s];
+      fadeFrom( faded, data[s], n, x, fadeCurve_ );
+      faded += n;
+      x += n * fadeStep_;
+    }
+  }
+
+  fadeToPending( out, count, offset, [this]( StkFloat *pendingOut, unsigned long start, unsigned long, int n ) {
+    for ( int i=0; i<n; i++ )
+      pendingOut[i] = inputs_[ wrap( start + i ) ];
+  } );
 }
 
-void Delay :: tapIn( StkFloat value, unsigned long tapDelay )
+void Delay :: fadeFrom( StkFloat *out, const StkFloat *old, int count, StkFloat x, CrossfadeCurve curve ) const
 {
-  long tap = inPoint_ - tapDelay - 1;
-  while ( tap < 0 ) // Check for wraparound.
-    tap += inputs_.size();
-
-  inputs_[tap] = value;
+  // The fade position is counted in an int and the step is kept in a local so the
+  // loops vectorize (there is no packed unsigned long to StkFloat conversion, and out
+  // could otherwise alias fadeStep_).
+  const StkFloat step = fadeStep_;
+  if ( curve == LINEAR ) {
+    for ( int i=0; i<count; i++ )
+      out[i] = old[i] + ( x + i * step ) * ( out[i] - old[i] );
+  }
+  else {
+    for ( int i=0; i<count; i++ ) {
+      StkFloat oldGain, newGain;
+      equalPowerGains( x + i * step, oldGain, newGain );
+      out[i] = oldGain * old[i] + newGain * out[i];
+    }
+  }
 }
 
-StkFloat Delay :: addTo( StkFloat value, unsigned long tapDelay )
+void Delay :: writeBlock( const StkFloat *in, unsigned long count )
 {
-  long tap = inPoint_ - tapDelay - 1;
-  while ( tap < 0 ) // Check for wraparound.
-    tap += inputs_.size();
+  if ( count == 0 ) return;
+
+  StkFloat *data[2];
+  unsigned long sizes[2];
+  unsigned int nSpans = inSpans( count, data, sizes );
+
+  for ( unsigned int s=0; s<nSpans; s++ ) {
+    StkFloat *dst = data[s];
+    for ( unsigned long i=0; i<sizes[s]; i++ )
+      dst[i] = in[i] * gain_;
+    in += sizes[s];
+  }
+
+  advance( count );
 
-  return inputs_[tap]+= value;
+  // Same as the last tick() output: read after the last input was written.
+  lastFrame_[0] = inputs_[ wrap( outPoint_ - 1 ) ];
 }
 
 } // stk namespace
@@ -1,7 +1,9 @@
 #ifndef STK_DELAY_H
 #define STK_DELAY_H
 
-#include "Filter.h"
+#include "RingBuffer.h"
+#include "Interpolation.h"
+#include <algorithm>
 
 namespace stk {
 
@@ -17,14 +19,28 @@ namespace stk {
     A non-interpolating delay line is typically used in fixed
     delay-length applications, such as for reverberation.
 
+    The storage length is rounded up to a power of two (see
+    RingBuffer), so the maximum delay can be larger than requested.
+
+    Delay-length changes can optionally be crossfaded (see
+    setCrossfade()).  While a crossfade is in progress the output is
+    a mix of the old and new read positions; otherwise reads cost the
+    same as without crossfading.
+
     by Perry R. Cook and Gary P. Scavone, 1995--2019.
 */
 /***************************************************/
 
-class Delay : public Filter
+class Delay : public RingBuffer
 {
 public:
 
+  //! Gain curves for crossfading delay-length changes.
+  enum CrossfadeCurve {
+    LINEAR,     /*!< Gains sum to one, for correlated signals. */
+    EQUAL_POWER /*!< Squared gains sum to one, for uncorrelated signals. */
+  };
+
   //! The default constructor creates a delay-line with maximum length of 4095 samples and zero delay.
   /*!
     An StkError will be thrown if the delay parameter is less than
@@ -51,13 +67,66 @@ public:
 
   //! Set the delay-line length.
   /*!
-    The valid range for \e delay is from 0 to the maximum delay-line length.
+    The valid range for \e delay is from 0 to the maximum delay-line
+    length.  If crossfading is enabled, the output fades from the old
+    read position to the new one.  A change made while a crossfade is
+    in progress is held until that crossfade finishes; only the most
+    recent held value is kept.
   */
   void setDelay( unsigned long delay );
 
   //! Return the current delay-line length.
   unsigned long getDelay( void ) const { return delay_; };
 
+  //! Crossfade delay-length changes over \e samples samples with the given \e curve.
+  /*!
+    A length of zero (the default) disables crossfading, so that
+    setDelay() moves the read position in one step.  Any crossfade in
+    progress is finished immediately.
+  */
+  void setCrossfade( unsigned long samples, CrossfadeCurve curve = EQUAL_POWER );
+
+  //! Set the curve for crossfades that start from now on, leaving any crossfade in progress as it is.
+  /*!
+    This lets the curve follow the kind of change, e.g. LINEAR for
+    small steps where the old and new read positions hear nearly the
+    same signal, and EQUAL_POWER for jumps between unrelated parts of
+    the line.  A held change (see setDelay()) uses the curve set when
+    its crossfade starts.
+  */
+  void setCrossfadeCurve( CrossfadeCurve curve ) { nextFadeCurve_ = curve; };
+
+  //! Return the crossfade length in samples, zero if crossfading is disabled.
+  unsigned long getCrossfadeLength( void ) const { return fadeLength_; };
+
+  //! Return true while a delay-length crossfade is in progress.
+  bool isCrossfading( void ) const { return fadePos_ < fadeLength_; };
+
+  //! Finish any crossfade in progress at once, jumping to the most recent delay length.
+  void endCrossfade( void );
+
+  //! Return the shortest delay currently being read.
+  /*!
+    This is the delay length, or the smallest of the old and new
+    lengths while a crossfade is in progress, and of a held change
+    (see setDelay()), which a block read can already reach.
+  */
+  unsigned long getMinimumReadDelay( void ) const {
+    if ( !isCrossfading() ) return delay_;
+    unsigned long delay = std::min( delay_, fadeFromDelay_ );
+    return hasPendingDelay_ ? std::min( delay, pendingDelay_ ) : delay;
+  };
+
+  //! Return the longest delay currently being read.
+  /*!
+    Like getMinimumReadDelay(), but the largest of the lengths.
+  */
+  unsigned long getMaximumReadDelay( void ) const {
+    if ( !isCrossfading() ) return delay_;
+    unsigned long delay = std::max( delay_, fadeFromDelay_ );
+    return hasPendingDelay_ ? std::max( delay, pendingDelay_ ) : delay;
+  };
+
   //! Return the value at \e tapDelay samples from the delay-line input.
   /*!
     The tap point is determined modulo the delay-line length and is
@@ -84,7 +153,7 @@ public:
   /*!
     This method is valid only for delay settings greater than zero!
    */
-  StkFloat nextOut( void ) { return inputs_[outPoint_]; };
+  StkFloat nextOut( void ) { return isCrossfading() ? crossfadeOut( 0 ) : inputs_[outPoint_]; };
 
   //! Calculate and return the signal energy in the delay-line.
   StkFloat energy( void ) const;
@@ -114,26 +183,150 @@ public:
   */
   StkFrames& tick( StkFrames& iFrames, StkFrames &oFrames, unsigned int iChannel = 0, unsigned int oChannel = 0 );
 
+  //! Get the delay-line storage for the next \e count output samples, split where the delay-line wraps.
+  /*!
+    The region starts \e offset samples past the value returned by
+    nextOut().  It is returned as at most two contiguous spans in \c
+    data and \c sizes, and the number of spans used (1 or 2) is
+    returned.  Nothing is advanced.  \e offset must be less than the
+    delay-line length and \e count must not exceed it.  Range
+    checking is only performed if _STK_DEBUG_ is defined during
+    compilation, in which case an out-of-range value will trigger an
+    StkError exception.
+  */
+  unsigned int outSpans( unsigned long count, StkFloat *data[2], unsigned long sizes[2], unsigned long offset = 0 );
+
+  //! Get the delay-line storage that the next \e count inputs will be written to, split where the delay-line wraps.
+  /*!
+    Works like outSpans(), starting at the current write position.
+    Values written through these pointers are not scaled by the
+    filter gain.  Call advance() once they have been written.
+  */
+  unsigned int inSpans( unsigned long count, StkFloat *data[2], unsigned long sizes[2] );
+
+  //! Move the read and write positions forward by \e count samples.
+  void advance( unsigned long count );
+
+  //! Copy the next \e count outputs, starting \e offset samples past nextOut(), into \e out without advancing.
+  /*!
+    The outputs include any crossfade in progress, as it stands now.
+    A change held behind that crossfade starts crossfading on the
+    sample where it ends, as with tick(), and advance() keeps track
+    of it from there.
+  */
+  void readBlock( StkFloat *out, unsigned long count, unsigned long offset = 0 );
+
+  //! Like readBlock(), but with output \e i read \e extraDelay[i] samples further back.
+  /*!
+    The extra delays are fractional and must not be negative.  Each
+    output is interpolated from \c Interpolator::points neighbouring
+    samples (third-order Lagrange by default, see Interpolation.h for
+    the others), the newest of them \c Interpolator::newer samples
+    newer than the readBlock() output at the same position.  So a
+    block read before it is written must be at least newer + 1
+    samples shorter than the delay, and the extra delay plus points
+    must not be longer than the storage.
+
+    This is for modulating the delay length at audio rate: the
+    outputs are worked out a block at a time, in loops that vectorize
+    except for fetching the samples, instead of per-sample setDelay()
+    calls like stk::DelayL needs.
+  */
+  template <class Interpolator = Lagrange<3> >
+  void readBlock( StkFloat *out, unsigned long count, const StkFloat *extraDelay, unsigned long offset = 0 );
+
+  //! Write \e count inputs and advance, like \e count calls to tick() with the outputs discarded.
+  void writeBlock( const StkFloat *in, unsigned long count );
+
 protected:
 
-  unsigned long inPoint_;
+  void setReadPoint( unsigned long delay );
+  void startCrossfade( unsigned long delay );
+  void stepCrossfade( unsigned long count );
+  StkFloat crossfadeOut( unsigned long offset );
+  StkFloat crossfadeTick( StkFloat input );
+  void crossfadeGains( unsigned long position, StkFloat &oldGain, StkFloat &newGain ) const;
+  void fadeFrom( StkFloat *out, const StkFloat *old, int count, StkFloat x, CrossfadeCurve curve ) const;
+  template <class Read>
+  void fadeToPending( StkFloat *out, unsigned long count, unsigned long offset, Read read );
+
   unsigned long outPoint_;
   unsigned long delay_;
+
+  unsigned long fadeLength_;
+  unsigned long fadePos_;      // == fadeLength_ when idle
+  unsigned long fadeOffset_;   // old read position - new read position, wrapped
+  unsigned long fadeFromDelay_;
+  unsigned long pendingDelay_;
+  bool hasPendingDelay_;
+  CrossfadeCurve fadeCurve_;      // of the crossfade in progress
+  CrossfadeCurve nextFadeCurve_;  // for the next one
+  StkFloat fadeStep_;          // 1 / fadeLength_
 };
 
+template <class Interpolator>
+void Delay :: readBlock( StkFloat *out, unsigned long count, const StkFloat *extraDelay, unsigned long offset )
+{
+  interpolate<Interpolator>( out, outPoint_ + offset, (int) count, extraDelay );
+
+  if ( !isCrossfading() ) return;
+
+  if ( fadePos_ + offset < fadeLength_ ) {
+    // Mix in the old read position, with the same extra delays, for the part of the
+    // block still inside the crossfade.
+    int fadeCount = (int) std::min( count, fadeLength_ - fadePos_ - offset );
+    StkFloat old[interpolationBlock];
+    StkFloat x = ( fadePos_ + offset ) * fadeStep_;
+    for ( int done=0; done<fadeCount; done+=interpolationBlock ) {
+      int n = std::min( interpolationBlock, fadeCount - done );
+      interpolate<Interpolator>( old, outPoint_ + offset + fadeOffset_ + done, n, extraDelay + done );
+      fadeFrom( out + done, old, n, x, fadeCurve_ );
+      x += n * fadeStep_;
+    }
+  }
+
+  fadeToPending( out, count, offset, [&]( StkFloat *dst, unsigned long start, unsigned long i, int n ) {
+    interpolate<Interpolator>( dst, start, n, extraDelay + i );
+  } );
+}
+
+template <class Read>
+void Delay :: fadeToPending( StkFloat *out, unsigned long count, unsigned long offset, Read read )
+{
+  // A held change starts on the sample where the crossfade in progress ends (see
+  // stepCrossfade()), fading from the current read position to its own.  Outputs
+  // from \c start on (counted like \e offset) are read from there.
+  unsigned long start = fadeLength_ - fadePos_;
+  if ( !hasPendingDelay_ || pendingDelay_ == delay_ || offset + count <= start ) return;
+
+  unsigned long i = start > offset ? start - offset : 0;
+  unsigned long pos = offset + i - start; // into the held change's crossfade
+  unsigned long pendingPoint = outPoint_ + offset + wrap( delay_ - pendingDelay_ );
+  StkFloat old[interpolationBlock];
+  while ( i < count ) {
+    int n = (int) std::min( count - i, (unsigned long) interpolationBlock );
+    if ( pos < fadeLength_ ) {
+      std::copy( out + i, out + i + n, old );
+      read( out + i, pendingPoint + i, i, n );
+      int fadeCount = (int) std::min( (unsigned long) n, fadeLength_ - pos );
+      fadeFrom( out + i, old, fadeCount, pos * fadeStep_, nextFadeCurve_ );
+    }
+    else read( out + i, pendingPoint + i, i, n );
+    i += n;
+    pos += n;
+  }
+}
+
 inline StkFloat Delay :: tick( StkFloat input )
 {
-  inputs_[inPoint_++] = input * gain_;
+  if ( isCrossfading() ) return crossfadeTick( input );
 
-  // Check for end condition
-  if ( inPoint_ == inputs_.size() )
-    inPoint_ = 0;
+  inputs_[inPoint_] = input * gain_;
+  inPoint_ = wrap( inPoint_ + 1 );
 
   // Read out next value
-  lastFrame_[0] = inputs_[outPoint_++];
-
-  if ( outPoint_ == inputs_.size() )
-    outPoint_ = 0;
+  lastFrame_[0] = inputs_[outPoint_];
+  outPoint_ = wrap( outPoint_ + 1 );
 
   return lastFrame_[0];
 }
@@ -149,11 +342,23 @@ inline StkFrames& Delay :: tick( StkFrames& frames, unsigned int channel )
 
   StkFloat *samples = &frames[channel];
   unsigned int hop = frames.channels();
-  for ( unsigned int i=0; i<frames.frames(); i++, samples += hop ) {
-    inputs_[inPoint_++] = *samples * gain_;
-    if ( inPoint_ == inputs_.size() ) inPoint_ = 0;
-    *samples = inputs_[outPoint_++];
-    if ( outPoint_ == inputs_.size() ) outPoint_ = 0;
+  unsigned long remaining = frames.frames();
+  for ( ; remaining > 0 && isCrossfading(); remaining--, samples += hop )
+    *samples = crossfadeTick( *samples );
+
+  // Run between wrap points so the inner loop has no wrap checks.
+  StkFloat *data = &inputs_[0];
+  unsigned long length = inputs_.size();
+  while ( remaining > 0 ) {
+    unsigned long n = std::min( remaining, std::min( length - inPoint_, length - outPoint_ ) );
+    StkFloat *in = data + inPoint_, *out = data + outPoint_;
+    for ( unsigned long i=0; i<n; i++, samples += hop ) {
+      in[i] = *samples * gain_;
+      *samples = out[i];
+    }
+    inPoint_ = wrap( inPoint_ + n );
+    outPoint_ = wrap( outPoint_ + n );
+    remaining -= n;
   }
 
   lastFrame_[0] = *(samples-hop);
@@ -172,17 +377,74 @@ inline StkFrames& Delay :: tick( StkFrames& iFrames, StkFrames& oFrames, unsigne
   StkFloat *iSamples = &iFrames[iChannel];
   StkFloat *oSamples = &oFrames[oChannel];
   unsigned int iHop = iFrames.channels(), oHop = oFrames.channels();
-  for ( unsigned int i=0; i<iFrames.frames(); i++, iSamples += iHop, oSamples += oHop ) {
-    inputs_[inPoint_++] = *iSamples * gain_;
-    if ( inPoint_ == inputs_.size() ) inPoint_ = 0;
-    *oSamples = inputs_[outPoint_++];
-    if ( outPoint_ == inputs_.size() ) outPoint_ = 0;
+  unsigned long remaining = iFrames.frames();
+  for ( ; remaining > 0 && isCrossfading(); remaining--, iSamples += iHop, oSamples += oHop )
+    *oSamples = crossfadeTick( *iSamples );
+
+  StkFloat *data = &inputs_[0];
+  unsigned long length = inputs_.size();
+  while ( remaining > 0 ) {
+    unsigned long n = std::min( remaining, std::min( length - inPoint_, length - outPoint_ ) );
+    StkFloat *in = data + inPoint_, *out = data + outPoint_;
+    for ( unsigned long i=0; i<n; i++, iSamples += iHop, oSamples += oHop ) {
+      in[i] = *iSamples * gain_;
+      *oSamples = out[i];
+    }
+    inPoint_ = wrap( inPoint_ + n );
+    outPoint_ = wrap( outPoint_ + n );
+    remaining -= n;
   }
 
   lastFrame_[0] = *(oSamples-oHop);
   return iFrames;
 }
 
+inline StkFloat Delay :: tapOut( unsigned long tapDelay )
+{
+  return inputs_[ tapPoint( tapDelay ) ];
+}
+
+inline void Delay :: tapIn( StkFloat value, unsigned long tapDelay )
+{
+  inputs_[ tapPoint( tapDelay ) ] = value;
+}
+
+inline StkFloat Delay :: addTo( StkFloat value, unsigned long tapDelay )
+{
+  return inputs_[ tapPoint( tapDelay ) ] += value;
+}
+
+inline unsigned int Delay :: outSpans( unsigned long count, StkFloat *data[2], unsigned long sizes[2], unsigned long offset )
+{
+#if defined(_STK_DEBUG_)
+  if ( offset >= inputs_.size() || count > inputs_.size() ) {
+    oStream_ << "Delay::outSpans(): offset or count exceeds the delay-line length!";
+    handleError( StkError::FUNCTION_ARGUMENT );
+  }
+#endif
+
+  return spans( outPoint_ + offset, count, data, sizes );
+}
+
+inline unsigned int Delay :: inSpans( unsigned long count, StkFloat *data[2], unsigned long sizes[2] )
+{
+#if defined(_STK_DEBUG_)
+  if ( count > inputs_.size() ) {
+    oStream_ << "Delay::inSpans(): count exceeds the delay-line length!";
+    handleError( StkError::FUNCTION_ARGUMENT );
+  }
+#endif
+
+  return spans( inPoint_, count, data, sizes );
+}
+
+inline void Delay :: advance( unsigned long count )
+{
+  inPoint_ = wrap( inPoint_ + count );
+  outPoint_ = wrap( outPoint_ + count );
+  if ( isCrossfading() ) stepCrossfade( count );
+}
+
 } // stk namespace
 
 #endif
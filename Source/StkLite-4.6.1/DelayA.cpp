@@ -35,10 +35,8 @@ DelayA :: DelayA( StkFloat delay, unsigned long maxDelay )
   }
 
   // Writing before reading allows delays from 0 to length-1. 
-  if ( maxDelay + 1 > inputs_.size() )
-    inputs_.resize( maxDelay + 1, 1, 0.0 );
+  allocate( maxDelay + 1 );
 
-  inPoint_ = 0;
   this->setDelay( delay );
   apInput_ = 0.0;
   doNextOut_ = true;
@@ -59,7 +57,7 @@ void DelayA :: clear()
 void DelayA :: setMaximumDelay( unsigned long delay )
 {
   if ( delay < inputs_.size() ) return;
-  inputs_.resize(delay + 1, 1, 0.0);
+  allocate( delay + 1 );
 }
 
 void DelayA :: setDelay( StkFloat delay )
@@ -75,43 +73,28 @@ void DelayA :: setDelay( StkFloat delay )
     handleError( StkError::WARNING );
   }
 
-  StkFloat outPointer = inPoint_ - delay + 1.0;     // outPoint chases inpoint
+  // outPoint chases inpoint: outPoint_ - alpha_ = inPoint_ - delay, wrapped
+  unsigned long whole = (unsigned long) delay;
+  StkFloat fraction = delay - whole;
   delay_ = delay;
 
-  while ( outPointer < 0 )
-    outPointer += length;  // modulo maximum length
-
-  outPoint_ = (long) outPointer;         // integer part
-  if ( outPoint_ == length ) outPoint_ = 0;
-  alpha_ = 1.0 + outPoint_ - outPointer; // fractional part
+  if ( fraction > 0.0 ) {
+    outPoint_ = wrap( inPoint_ - whole ); // integer part
+    alpha_ = fraction;                    // fractional part
+  }
+  else {
+    outPoint_ = wrap( inPoint_ - whole + 1 );
+    alpha_ = 1.0;
+  }
 
   if ( alpha_ < 0.5 ) {
     // The optimal range for alpha is about 0.5 - 1.5 in order to
     // achieve the flattest phase delay response.
-    outPoint_ += 1;
-    if ( outPoint_ >= length ) outPoint_ -= length;
+    outPoint_ = wrap( outPoint_ + 1 );
     alpha_ += (StkFloat) 1.0;
   }
 
   coeff_ = (1.0 - alpha_) / (1.0 + alpha_);  // coefficient for allpass
 }
 
-StkFloat DelayA :: tapOut( unsigned long tapDelay )
-{
-  long tap = inPoint_ - tapDelay - 1;
-  while ( tap < 0 ) // Check for wraparound.
-    tap += inputs_.size();
-
-  return inputs_[tap];
-}
-
-void DelayA :: tapIn( StkFloat value, unsigned long tapDelay )
-{
-  long tap = inPoint_ - tapDelay - 1;
-  while ( tap < 0 ) // Check for wraparound.
-    tap += inputs_.size();
-
-  inputs_[tap] = value;
-}
-
 } // stk namespace
@@ -1,7 +1,7 @@
 #ifndef STK_DELAYA_H
 #define STK_DELAYA_H
 
-#include "Filter.h"
+#include "RingBuffer.h"
 
 namespace stk {
 
@@ -21,11 +21,14 @@ namespace stk {
     minimum delay possible in this implementation is limited to a
     value of 0.5.
 
+    The storage length is rounded up to a power of two (see
+    RingBuffer), so the maximum delay can be larger than requested.
+
     by Perry R. Cook and Gary P. Scavone, 1995--2019.
 */
 /***************************************************/
 
-class DelayA : public Filter
+class DelayA : public RingBuffer
 {
 public:
 
@@ -112,7 +115,6 @@ public:
 
 protected:  
 
-  unsigned long inPoint_;
   unsigned long outPoint_;
   StkFloat delay_;
   StkFloat alpha_;
@@ -134,21 +136,29 @@ inline StkFloat DelayA :: nextOut( void )
   return nextOutput_;
 }
 
+inline StkFloat DelayA :: tapOut( unsigned long tapDelay )
+{
+  return inputs_[ tapPoint( tapDelay ) ];
+}
+
+inline void DelayA :: tapIn( StkFloat value, unsigned long tapDelay )
+{
+  inputs_[ tapPoint( tapDelay ) ] = value;
+}
+
 inline StkFloat DelayA :: tick( StkFloat input )
 {
-  inputs_[inPoint_++] = input * gain_;
+  inputs_[inPoint_] = input * gain_;
 
   // Increment input pointer modulo length.
-  if ( inPoint_ == inputs_.size() )
-    inPoint_ = 0;
+  inPoint_ = wrap( inPoint_ + 1 );
 
   lastFrame_[0] = nextOut();
   doNextOut_ = true;
 
   // Save the allpass input and increment modulo length.
-  apInput_ = inputs_[outPoint_++];
-  if ( outPoint_ == inputs_.size() )
-    outPoint_ = 0;
+  apInput_ = inputs_[outPoint_];
+  outPoint_ = wrap( outPoint_ + 1 );
 
   return lastFrame_[0];
 }
@@ -165,13 +175,13 @@ inline StkFrames& DelayA :: tick( StkFrames& frames, unsigned int channel )
   StkFloat *samples = &frames[channel];
   unsigned int hop = frames.channels();
   for ( unsigned int i=0; i<frames.frames(); i++, samples += hop ) {
-    inputs_[inPoint_++] = *samples * gain_;
-    if ( inPoint_ == inputs_.size() ) inPoint_ = 0;
+    inputs_[inPoint_] = *samples * gain_;
+    inPoint_ = wrap( inPoint_ + 1 );
     *samples = nextOut();
     lastFrame_[0] = *samples;
     doNextOut_ = true;
-    apInput_ = inputs_[outPoint_++];
-    if ( outPoint_ == inputs_.size() ) outPoint_ = 0;
+    apInput_ = inputs_[outPoint_];
+    outPoint_ = wrap( outPoint_ + 1 );
   }
 
   return frames;
@@ -190,13 +200,13 @@ inline StkFrames& DelayA :: tick( StkFrames& iFrames, StkFrames& oFrames, unsign
   StkFloat *oSamples = &oFrames[oChannel];
   unsigned int iHop = iFrames.channels(), oHop = oFrames.channels();
   for ( unsigned int i=0; i<iFrames.frames(); i++, iSamples += iHop, oSamples += oHop ) {
-    inputs_[inPoint_++] = *iSamples * gain_;
-    if ( inPoint_ == inputs_.size() ) inPoint_ = 0;
+    inputs_[inPoint_] = *iSamples * gain_;
+    inPoint_ = wrap( inPoint_ + 1 );
     *oSamples = nextOut();
     lastFrame_[0] = *oSamples;
     doNextOut_ = true;
-    apInput_ = inputs_[outPoint_++];
-    if ( outPoint_ == inputs_.size() ) outPoint_ = 0;
+    apInput_ = inputs_[outPoint_];
+    outPoint_ = wrap( outPoint_ + 1 );
   }
 
   return iFrames;
@@ -34,10 +34,8 @@ DelayL :: DelayL( StkFloat delay, unsigned long maxDelay )
   }
 
   // Writing before reading allows delays from 0 to length-1. 
-  if ( maxDelay + 1 > inputs_.size() )
-    inputs_.resize( maxDelay + 1, 1, 0.0 );
+  allocate( maxDelay + 1 );
 
-  inPoint_ = 0;
   this->setDelay( delay );
   doNextOut_ = true;
 }
@@ -49,25 +47,7 @@ DelayL :: ~DelayL()
 void DelayL :: setMaximumDelay( unsigned long delay )
 {
   if ( delay < inputs_.size() ) return;
-  inputs_.resize(delay + 1, 1, 0.0);
-}
-
-StkFloat DelayL :: tapOut( unsigned long tapDelay )
-{
-  long tap = inPoint_ - tapDelay - 1;
-  while ( tap < 0 ) // Check for wraparound.
-    tap += inputs_.size();
-
-  return inputs_[tap];
-}
-
-void DelayL :: tapIn( StkFloat value, unsigned long tapDelay )
-{
-  long tap = inPoint_ - tapDelay - 1;
-  while ( tap < 0 ) // Check for wraparound.
-    tap += inputs_.size();
-
-  inputs_[tap] = value;
+  allocate( delay + 1 );
 }
 
 } // stk namespace
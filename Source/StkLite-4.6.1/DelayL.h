@@ -1,7 +1,7 @@
 #ifndef STK_DELAYL_H
 #define STK_DELAYL_H
 
-#include "Filter.h"
+#include "RingBuffer.h"
 
 namespace stk {
 
@@ -20,11 +20,14 @@ namespace stk {
     delay setting.  The use of higher order Lagrange interpolators can
     typically improve (minimize) this attenuation characteristic.
 
+    The storage length is rounded up to a power of two (see
+    RingBuffer), so the maximum delay can be larger than requested.
+
     by Perry R. Cook and Gary P. Scavone, 1995--2019.
 */
 /***************************************************/
 
-class DelayL : public Filter
+class DelayL : public RingBuffer
 {
 public:
 
@@ -108,7 +111,6 @@ public:
 
  protected:
 
-  unsigned long inPoint_;
   unsigned long outPoint_;
   StkFloat delay_;
   StkFloat alpha_;
@@ -123,10 +125,7 @@ inline StkFloat DelayL :: nextOut( void )
     // First 1/2 of interpolation
     nextOutput_ = inputs_[outPoint_] * omAlpha_;
     // Second 1/2 of interpolation
-    if (outPoint_+1 < inputs_.size())
-      nextOutput_ += inputs_[outPoint_+1] * alpha_;
-    else
-      nextOutput_ += inputs_[0] * alpha_;
+    nextOutput_ += inputs_[ wrap( outPoint_ + 1 ) ] * alpha_;
     doNextOut_ = false;
   }
 
@@ -145,39 +144,49 @@ inline void DelayL :: setDelay( StkFloat delay )
     handleError( StkError::WARNING ); return;
   }
 
-  StkFloat outPointer = inPoint_ - delay;  // read chases write
+  // read chases write: outPoint_ + alpha_ = inPoint_ - delay, wrapped
+  unsigned long whole = (unsigned long) delay;
+  StkFloat fraction = delay - whole;
   delay_ = delay;
 
-  while ( outPointer < 0 )
-    outPointer += inputs_.size(); // modulo maximum length
-
-  outPoint_ = (long) outPointer;   // integer part
-
-  alpha_ = outPointer - outPoint_; // fractional part
+  if ( fraction > 0.0 ) {
+    outPoint_ = wrap( inPoint_ - whole - 1 ); // integer part
+    alpha_ = (StkFloat) 1.0 - fraction;       // fractional part
+  }
+  else {
+    outPoint_ = wrap( inPoint_ - whole );
+    alpha_ = 0.0;
+  }
   omAlpha_ = (StkFloat) 1.0 - alpha_;
-
-  if ( outPoint_ == inputs_.size() ) outPoint_ = 0;
   doNextOut_ = true;
 }
 
 inline StkFloat DelayL :: tick( StkFloat input )
 {
-  inputs_[inPoint_++] = input * gain_;
+  inputs_[inPoint_] = input * gain_;
 
   // Increment input pointer modulo length.
-  if ( inPoint_ == inputs_.size() )
-    inPoint_ = 0;
+  inPoint_ = wrap( inPoint_ + 1 );
 
   lastFrame_[0] = nextOut();
   doNextOut_ = true;
 
   // Increment output pointer modulo length.
-  if ( ++outPoint_ == inputs_.size() )
-    outPoint_ = 0;
+  outPoint_ = wrap( outPoint_ + 1 );
 
   return lastFrame_[0];
 }
 
+inline StkFloat DelayL :: tapOut( unsigned long tapDelay )
+{
+  return inputs_[ tapPoint( tapDelay ) ];
+}
+
+inline void DelayL :: tapIn( StkFloat value, unsigned long tapDelay )
+{
+  inputs_[ tapPoint( tapDelay ) ] = value;
+}
+
 inline StkFrames& DelayL :: tick( StkFrames& frames, unsigned int channel )
 {
 #if defined(_STK_DEBUG_)
@@ -190,11 +199,11 @@ inline StkFrames& DelayL :: tick( StkFrames& frames, unsigned int channel )
   StkFloat *samples = &frames[channel];
   unsigned int hop = frames.channels();
   for ( unsigned int i=0; i<frames.frames(); i++, samples += hop ) {
-    inputs_[inPoint_++] = *samples * gain_;
-    if ( inPoint_ == inputs_.size() ) inPoint_ = 0;
+    inputs_[inPoint_] = *samples * gain_;
+    inPoint_ = wrap( inPoint_ + 1 );
     *samples = nextOut();
     doNextOut_ = true;
-    if ( ++outPoint_ == inputs_.size() ) outPoint_ = 0;
+    outPoint_ = wrap( outPoint_ + 1 );
   }
 
   lastFrame_[0] = *(samples-hop);
@@ -214,11 +223,11 @@ inline StkFrames& DelayL :: tick( StkFrames& iFrames, StkFrames& oFrames, unsign
   StkFloat *oSamples = &oFrames[oChannel];
   unsigned int iHop = iFrames.channels(), oHop = oFrames.channels();
   for ( unsigned int i=0; i<iFrames.frames(); i++, iSamples += iHop, oSamples += oHop ) {
-    inputs_[inPoint_++] = *iSamples * gain_;
-    if ( inPoint_ == inputs_.size() ) inPoint_ = 0;
+    inputs_[inPoint_] = *iSamples * gain_;
+    inPoint_ = wrap( inPoint_ + 1 );
     *oSamples = nextOut();
     doNextOut_ = true;
-    if ( ++outPoint_ == inputs_.size() ) outPoint_ = 0;
+    outPoint_ = wrap( outPoint_ + 1 );
   }
 
   lastFrame_[0] = *(oSamples-oHop);
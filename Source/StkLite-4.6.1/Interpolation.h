@@ -0,0 +1,179 @@
+#ifndef STK_INTERPOLATION_H
+#define STK_INTERPOLATION_H
+
+#include "RingBuffer.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace stk {
+
+/***************************************************/
+/*! \class Lagrange
+    \brief STK Lagrange fractional-delay interpolation kernel.
+
+    The interpolation kernels are template arguments for the
+    modulated block reads (see Delay::readBlock()).  Each one weighs
+    \c points neighbouring samples, x0 (the newest) to x[points-1],
+    where x0 is \c newer samples newer than the position an
+    unmodulated read would return, so the fractional part of the
+    delay lands in the middle of the kernel.  weights() works out
+    the weights of a whole run of fractions at once, in loops that
+    vectorize.
+
+    Lagrange<Order> is the maximally flat interpolator through \e
+    Order + 1 points: Order 1 is linear interpolation (as in DelayL),
+    3 and 5 are the usual higher orders.  Even orders would be off
+    center, so only odd ones are meant to be used.
+
+    by Perry R. Cook and Gary P. Scavone, 1995--2019.
+*/
+/***************************************************/
+
+template <int Order>
+struct Lagrange
+{
+  static const int points = Order + 1;
+  static const int newer = ( Order - 1 ) / 2;
+
+  //! Set h[k][i] to the weight of x[k] for a delay of newer + \e frac[i] behind x0, for \e count fractions.
+  static void weights( const StkFloat *frac, int count, StkFloat h[][RingBuffer::interpolationBlock] )
+  {
+    // h_k = prod_{j != k} (d - j) / (k - j), from the products of d - j on
+    // either side of k
+    StkFloat scale[points];
+    for ( int k=0; k<points; k++ ) {
+      double denominator = 1;
+      for ( int j=0; j<points; j++ )
+        if ( j != k ) denominator *= k - j;
+      scale[k] = 1.0 / denominator;
+    }
+
+    for ( int i=0; i<count; i++ ) {
+      StkFloat d = newer + frac[i];
+      StkFloat after[points];
+      after[points - 1] = 1;
+      for ( int k=points-2; k>=0; k-- )
+        after[k] = after[k + 1] * ( d - ( k + 1 ) );
+      StkFloat before = 1;
+      for ( int k=0; k<points; k++ ) {
+        h[k][i] = scale[k] * before * after[k];
+        before *= d - k;
+      }
+    }
+  }
+};
+
+/***************************************************/
+/*! \class Hermite4
+    \brief STK 4-point, third-order Hermite (Catmull-Rom) interpolation kernel.
+
+    The interpolated curve has a continuous slope from one sample
+    to the next, which Lagrange<3>'s doesn't, but it is less accurate
+    at low frequencies for about the same cost.  See Lagrange for how
+    kernels are used.
+
+    by Perry R. Cook and Gary P. Scavone, 1995--2019.
+*/
+/***************************************************/
+
+struct Hermite4
+{
+  static const int points = 4;
+  static const int newer = 1;
+
+  //! Set h[k][i] to the weight of x[k] for a delay of 1 + \e frac[i] behind x0, for \e count fractions.
+  static void weights( const StkFloat *frac, int count, StkFloat h[][RingBuffer::interpolationBlock] )
+  {
+    // the read position is frac past x1, towards x2
+    const StkFloat half = 0.5, oneAndHalf = 1.5, twoAndHalf = 2.5;
+    for ( int i=0; i<count; i++ ) {
+      StkFloat t = frac[i], t2 = t * t, t3 = t2 * t;
+      h[0][i] = t2 - half * ( t + t3 );
+      h[1][i] = 1 - twoAndHalf * t2 + oneAndHalf * t3;
+      h[2][i] = half * t + 2 * t2 - oneAndHalf * t3;
+      h[3][i] = half * ( t3 - t2 );
+    }
+  }
+};
+
+/***************************************************/
+/*! \class WindowedSinc
+    \brief STK polyphase windowed-sinc interpolation kernel.
+
+    A \e Taps point sinc, Kaiser windowed, tabulated at \e Phases + 1
+    evenly spaced fractions and linearly interpolated between them.
+    Each table row is normalized to unit DC gain.  It keeps more of
+    the top octave than the polynomial kernels, at the cost of a
+    table lookup per tap.  The table is built on first use, so call
+    table() once outside the audio thread.  See Lagrange for how
+    kernels are used.
+
+    by Perry R. Cook and Gary P. Scavone, 1995--2019.
+*/
+/***************************************************/
+
+template <int Taps, int Phases>
+struct WindowedSinc
+{
+  static const int points = Taps;
+  static const int newer = Taps / 2 - 1;
+
+  //! Return the ( \e Phases + 1 ) x \e Taps table of weights, row p for a fraction of p / \e Phases.
+  static const StkFloat *table( void )
+  {
+    static const std::vector<StkFloat> rows = makeTable();
+    return rows.data();
+  }
+
+  //! Set h[k][i] to the weight of x[k] for a delay of newer + \e frac[i] behind x0, for \e count fractions.
+  static void weights( const StkFloat *frac, int count, StkFloat h[][RingBuffer::interpolationBlock] )
+  {
+    const StkFloat *rows = table();
+    for ( int i=0; i<count; i++ ) {
+      StkFloat x = frac[i] * Phases;
+      int phase = (int) x;
+      StkFloat t = x - phase;
+      const StkFloat *row = rows + phase * Taps;
+      for ( int k=0; k<Taps; k++ )
+        h[k][i] = row[k] + t * ( row[k + Taps] - row[k] );
+    }
+  }
+
+private:
+  static std::vector<StkFloat> makeTable( void )
+  {
+    const double beta = 6.0; // Kaiser window shape, about -60 dB sidelobes
+    std::vector<StkFloat> rows( ( Phases + 1 ) * Taps );
+    for ( int p=0; p<=Phases; p++ ) {
+      double d = newer + (double) p / Phases;
+      double sum = 0;
+      for ( int k=0; k<Taps; k++ ) {
+        double x = k - d;                   // from the read position, -Taps/2 to Taps/2
+        double r = x / ( Taps / 2.0 );      // -1 to 1 across the window
+        double sinc = x == 0 ? 1 : std::sin( PI * x ) / ( PI * x );
+        double window = besselI0( beta * std::sqrt( std::max( 0.0, 1 - r * r ) ) ) / besselI0( beta );
+        rows[p * Taps + k] = sinc * window;
+        sum += sinc * window;
+      }
+      for ( int k=0; k<Taps; k++ )
+        rows[p * Taps + k] /= sum;
+    }
+    return rows;
+  }
+
+  // zeroth-order modified Bessel function of the first kind, from its power series
+  static double besselI0( double x )
+  {
+    double term = 1, sum = 1;
+    for ( int n=1; n<32; n++ ) {
+      term *= ( x / ( 2 * n ) ) * ( x / ( 2 * n ) );
+      sum += term;
+    }
+    return sum;
+  }
+};
+
+} // stk namespace
+
+#endif
@@ -74,6 +74,17 @@ class PoleZero : public Filter
   */
   StkFrames& tick( StkFrames& frames, unsigned int channel = 0 );
 
+  //! Take a channel of the \c iFrames object as inputs to the filter and write outputs to the \c oFrames object.
+  /*!
+    The \c iFrames object reference is returned.  Each channel
+    argument must be less than the number of channels in the
+    corresponding StkFrames argument (the first channel is specified
+    by 0).  However, range checking is only performed if _STK_DEBUG_
+    is defined during compilation, in which case an out-of-range value
+    will trigger an StkError exception.
+  */
+  StkFrames& tick( StkFrames& iFrames, StkFrames &oFrames, unsigned int iChannel = 0, unsigned int oChannel = 0 );
+
 };
 
 inline StkFloat PoleZero :: tick( StkFloat input )
@@ -108,6 +119,29 @@ inline StkFrames& PoleZero :: tick( StkFrames& frames, unsigned int channel )
   return frames;
 }
 
+inline StkFrames& PoleZero :: tick( StkFrames& iFrames, StkFrames& oFrames, unsigned int iChannel, unsigned int oChannel )
+{
+#if defined(_STK_DEBUG_)
+  if ( iChannel >= iFrames.channels() || oChannel >= oFrames.channels() ) {
+    oStream_ << "PoleZero::tick(): channel and StkFrames arguments are incompatible!";
+    handleError( StkError::FUNCTION_ARGUMENT );
+  }
+#endif
+
+  StkFloat *iSamples = &iFrames[iChannel];
+  StkFloat *oSamples = &oFrames[oChannel];
+  unsigned int iHop = iFrames.channels(), oHop = oFrames.channels();
+  for ( unsigned int i=0; i<iFrames.frames(); i++, iSamples += iHop, oSamples += oHop ) {
+    inputs_[0] = gain_ * *iSamples;
+    *oSamples = b_[0] * inputs_[0] + b_[1] * inputs_[1] - a_[1] * outputs_[1];
+    inputs_[1] = inputs_[0];
+    outputs_[1] = *oSamples;
+  }
+
+  lastFrame_[0] = outputs_[1];
+  return iFrames;
+}
+
 } // stk namespace
 
 #endif
@@ -0,0 +1,200 @@
+#ifndef STK_RINGBUFFER_H
+#define STK_RINGBUFFER_H
+
+#include "Filter.h"
+#include <algorithm>
+
+namespace stk {
+
+/***************************************************/
+/*! \class RingBuffer
+    \brief STK power-of-two delay-line storage base class.
+
+    This class provides the circular storage shared by the delay-line
+    classes (Delay, DelayL, DelayA and TapDelay).  The storage length
+    is always rounded up to a power of two, so positions wrap with a
+    single bitmask instead of compare-and-reset tests or modulo loops,
+    and tap positions can be found in constant time for any tap
+    delay.
+
+    It also holds the interpolated block read shared by the modulated
+    reads (see interpolate() and the kernels in Interpolation.h).
+
+    Because of the rounding, the maximum delay of a derived class can
+    be larger than the value it was asked for.
+
+    by Perry R. Cook and Gary P. Scavone, 1995--2019.
+*/
+/***************************************************/
+
+class RingBuffer : public Filter
+{
+public:
+  //! Class constructor.
+  RingBuffer( void ) { inPoint_ = 0; mask_ = 0; };
+
+  //! Return the smallest power of two that is greater than or equal to \e size.
+  static unsigned long capacityFor( unsigned long size );
+
+  //! The longest run of outputs interpolate() works out in each pass, and the size of a kernel's weight arrays.
+  static constexpr int interpolationBlock = 64;
+
+  //! Clear only the \e count most recent inputs and the last output.
+  /*!
+    Delays shorter than \e count can only read these, so this is a
+    cheaper clear() when the storage is much longer than the delays
+    in use.
+  */
+  void clearRecent( unsigned long count );
+
+protected:
+
+  //! Make room for at least \e size samples, rounded up to a power of two.
+  /*!
+    If the storage is already big enough, nothing is changed.
+    Otherwise the new storage is cleared, so a signal discontinuity
+    will occur if this is used while the delay line is running.
+  */
+  void allocate( unsigned long size );
+
+  //! Return \e index wrapped to the storage length.
+  unsigned long wrap( unsigned long index ) const { return index & mask_; };
+
+  //! Return the storage position \e tapDelay samples behind the last input.
+  unsigned long tapPoint( unsigned long tapDelay ) const { return ( inPoint_ - tapDelay - 1 ) & mask_; };
+
+  //! Return the \e count samples of storage starting at \e start as at most two contiguous spans.
+  /*!
+    \e start is wrapped first.  The number of spans used (1 or 2) is
+    returned, and an unused second span is set to null and zero.
+  */
+  unsigned int spans( unsigned long start, unsigned long count, StkFloat *data[2], unsigned long sizes[2] );
+
+  //! Set the equal-power crossfade gains at position \e x (0 to 1) through the fade.
+  /*!
+    These are sin(pi/2 x) for the new signal and cos(pi/2 x) for the
+    old one, from a degree 9 Taylor polynomial accurate to about 4e-6
+    on [0, 1].
+  */
+  static void equalPowerGains( StkFloat x, StkFloat &oldGain, StkFloat &newGain );
+
+  //! Set \e count outputs, output i read \e extraDelay[i] samples behind storage position \e start + i.
+  /*!
+    The extra delays are fractional and must not be negative.  Each
+    output is weighed from \c Interpolator::points samples, the newest
+    \c Interpolator::newer samples ahead of \e start + i (see
+    Lagrange in Interpolation.h).
+  */
+  template <class Interpolator>
+  void interpolate( StkFloat *out, unsigned long start, int count, const StkFloat *extraDelay );
+
+  unsigned long inPoint_;
+  unsigned long mask_; // storage length - 1
+};
+
+inline unsigned long RingBuffer :: capacityFor( unsigned long size )
+{
+  unsigned long capacity = 1;
+  while ( capacity < size )
+    capacity <<= 1;
+  return capacity;
+}
+
+inline void RingBuffer :: allocate( unsigned long size )
+{
+  if ( size <= inputs_.size() ) return;
+
+  unsigned long capacity = capacityFor( size );
+  inputs_.resize( capacity, 1, 0.0 );
+  mask_ = capacity - 1;
+  inPoint_ &= mask_;
+}
+
+inline unsigned int RingBuffer :: spans( unsigned long start, unsigned long count, StkFloat *data[2], unsigned long sizes[2] )
+{
+  unsigned long length = inputs_.size();
+  start = wrap( start );
+
+  data[0] = &inputs_[start];
+  if ( count <= length - start ) {
+    sizes[0] = count;
+    data[1] = 0;
+    sizes[1] = 0;
+    return 1;
+  }
+
+  sizes[0] = length - start;
+  data[1] = &inputs_[0];
+  sizes[1] = count - sizes[0];
+  return 2;
+}
+
+inline void RingBuffer :: equalPowerGains( StkFloat x, StkFloat &oldGain, StkFloat &newGain )
+{
+  // Constants of type StkFloat, so a float build doesn't compute this in double.
+  const StkFloat c1 = 1.5707963, c3 = -0.6459641, c5 = 0.0796926, c7 = -0.0046817, c9 = 0.0001605;
+  StkFloat y = 1 - x;
+  StkFloat x2 = x * x, y2 = y * y;
+  newGain = x * ( c1 + x2 * ( c3 + x2 * ( c5 + x2 * ( c7 + x2 * c9 ) ) ) );
+  oldGain = y * ( c1 + y2 * ( c3 + y2 * ( c5 + y2 * ( c7 + y2 * c9 ) ) ) );
+}
+
+// Outputs are worked out in runs of four passes, so that only the second one, which
+// fetches the samples, is scalar: split each extra delay into whole samples and a
+// fraction, fetch the samples around each read position, weigh the fractions, and sum.
+template <class Interpolator>
+void RingBuffer :: interpolate( StkFloat *out, unsigned long start, int count, const StkFloat *extraDelay )
+{
+  const int points = Interpolator::points;
+  const StkFloat *samples = &inputs_[0];
+  int whole[interpolationBlock];
+  StkFloat frac[interpolationBlock];
+  StkFloat x[points][interpolationBlock];
+  StkFloat h[points][interpolationBlock];
+
+  for ( int done=0; done<count; done+=interpolationBlock ) {
+    int n = std::min( interpolationBlock, count - done );
+    const StkFloat *extra = extraDelay + done;
+    for ( int i=0; i<n; i++ ) {
+      whole[i] = (int) extra[i]; // the same as floor(), the extra delays aren't negative
+      frac[i] = extra[i] - whole[i];
+    }
+
+    unsigned long newest = start + done + Interpolator::newer;
+    for ( int i=0; i<n; i++ ) {
+      unsigned long p = newest + i - whole[i];
+      for ( int k=0; k<points; k++ )
+        x[k][i] = samples[wrap( p - k )];
+    }
+
+    Interpolator::weights( frac, n, h );
+
+    StkFloat *y = out + done;
+    for ( int i=0; i<n; i++ )
+      y[i] = h[0][i] * x[0][i];
+    for ( int k=1; k<points; k++ )
+      for ( int i=0; i<n; i++ )
+        y[i] += h[k][i] * x[k][i];
+  }
+}
+
+inline void RingBuffer :: clearRecent( unsigned long count )
+{
+  if ( count >= inputs_.size() ) {
+    clear();
+    return;
+  }
+
+  unsigned long start = wrap( inPoint_ - count );
+  unsigned long first = std::min( count, inputs_.size() - start );
+  std::fill( &inputs_[start], &inputs_[start] + first, 0.0 );
+  if ( first < count )
+    std::fill( &inputs_[0], &inputs_[0] + count - first, 0.0 );
+
+  for ( unsigned int i=0; i<lastFrame_.size(); i++ )
+    lastFrame_[i] = 0.0;
+}
+
+} // stk namespace
+
+#endif
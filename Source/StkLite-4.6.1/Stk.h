@@ -73,8 +73,14 @@ namespace stk {
 // Most data in STK is passed and calculated with the
 // following user-definable floating-point type.  You
 // can change this to "float" if you prefer or perhaps
-// a "long double" in the future.
+// a "long double" in the future.  Defining _STK_FLOAT32_
+// at compile time selects single precision, which halves
+// the size of delay-line and filter state.
+#if defined(_STK_FLOAT32_)
+typedef float StkFloat;
+#else
 typedef double StkFloat;
+#endif
 
 //! STK error handling class.
 /*!
@@ -35,10 +35,10 @@ TapDelay :: TapDelay( std::vector<unsigned long> taps, unsigned long maxDelay )
     }
   }
 
-  if ( ( maxDelay + 1 ) > inputs_.size() )
-    inputs_.resize( maxDelay + 1, 1, 0.0 );
+  allocate( maxDelay + 1 );
 
-  inPoint_ = 0;
+  fadeLength_ = 0;
+  fadeStep_ = 0.0;
   this->setTapDelays( taps );
 }
 
@@ -57,7 +57,8 @@ void TapDelay :: setMaximumDelay( unsigned long delay )
     }
   }
 
-  inputs_.resize( delay + 1 );
+  endCrossfades();
+  allocate( delay + 1 );
 }
 
 void TapDelay :: setTapDelays( std::vector<unsigned long> taps )
@@ -72,14 +73,189 @@ void TapDelay :: setTapDelays( std::vector<unsigned long> taps )
   if ( taps.size() != outPoint_.size() ) {
     outPoint_.resize( taps.size() );
     delays_.resize( taps.size() );
+    fadePos_.resize( taps.size() );
+    fadeOffset_.resize( taps.size() );
+    fadeFromDelay_.resize( taps.size() );
+    pendingDelay_.resize( taps.size() );
+    hasPendingDelay_.resize( taps.size() );
     lastFrame_.resize( 1, (unsigned int)taps.size(), 0.0 );
   }
 
   for ( unsigned int i=0; i<taps.size(); i++ ) {
     // read chases write
-    if ( inPoint_ >= taps[i] ) outPoint_[i] = inPoint_ - taps[i];
-    else outPoint_[i] = inputs_.size() + inPoint_ - taps[i];
+    outPoint_[i] = wrap( inPoint_ - taps[i] );
     delays_[i] = taps[i];
+    fadePos_[i] = fadeLength_;
+    hasPendingDelay_[i] = false;
+  }
+}
+
+void TapDelay :: setTapDelay( unsigned int tap, unsigned long delay )
+{
+#if defined(_STK_DEBUG_)
+  if ( tap >= outPoint_.size() ) {
+    oStream_ << "TapDelay::setTapDelay: tap argument (" << tap << ") is out of range!\n";
+    handleError( StkError::FUNCTION_ARGUMENT );
+  }
+#endif
+
+  if ( delay > inputs_.size() - 1 ) { // The value is too big.
+    oStream_ << "TapDelay::setTapDelay: argument (" << delay << ") greater than maximum!\n";
+    handleError( StkError::WARNING ); return;
+  }
+
+  if ( fadeLength_ > 0 ) {
+    if ( isCrossfading( tap ) ) {
+      pendingDelay_[tap] = delay;
+      hasPendingDelay_[tap] = true;
+    }
+    else if ( delay != delays_[tap] ) startCrossfade( tap, delay );
+    return;
+  }
+
+  outPoint_[tap] = wrap( inPoint_ - delay );
+  delays_[tap] = delay;
+}
+
+void TapDelay :: setCrossfade( unsigned long samples )
+{
+  endCrossfades();
+  fadeLength_ = samples;
+  fadeStep_ = samples > 0 ? 1.0 / samples : 0.0;
+  for ( unsigned int i=0; i<fadePos_.size(); i++ )
+    fadePos_[i] = samples;
+}
+
+void TapDelay :: endCrossfade( unsigned int tap )
+{
+  fadePos_[tap] = fadeLength_;
+  if ( hasPendingDelay_[tap] ) {
+    outPoint_[tap] = wrap( inPoint_ - pendingDelay_[tap] );
+    delays_[tap] = pendingDelay_[tap];
+  }
+  hasPendingDelay_[tap] = false;
+}
+
+void TapDelay :: endCrossfades( void )
+{
+  for ( unsigned int i=0; i<outPoint_.size(); i++ )
+    endCrossfade( i );
+}
+
+void TapDelay :: startCrossfade( unsigned int tap, unsigned long delay )
+{
+  fadeFromDelay_[tap] = delays_[tap];
+  fadeOffset_[tap] = wrap( delay - delays_[tap] );
+  fadePos_[tap] = 0;
+  outPoint_[tap] = wrap( inPoint_ - delay );
+  delays_[tap] = delay;
+}
+
+void TapDelay :: stepCrossfade( unsigned int tap, unsigned long count )
+{
+  unsigned long left = fadeLength_ - fadePos_[tap];
+  fadePos_[tap] = std::min( fadePos_[tap] + count, fadeLength_ );
+  if ( fadePos_[tap] == fadeLength_ && hasPendingDelay_[tap] ) {
+    hasPendingDelay_[tap] = false;
+    if ( pendingDelay_[tap] == delays_[tap] ) return;
+
+    // The held change starts where this crossfade ended, which may be part way
+    // through a block (see readBlock()).
+    startCrossfade( tap, pendingDelay_[tap] );
+    fadePos_[tap] = std::min( count - left, fadeLength_ );
+  }
+}
+
+void TapDelay :: fadeFrom( StkFloat *out, const StkFloat *old, int count, StkFloat x ) const
+{
+  // The fade position is counted in an int and the step is kept in a local so the
+  // loop vectorizes (there is no packed unsigned long to StkFloat conversion, and out
+  // could otherwise alias fadeStep_).
+  const StkFloat step = fadeStep_;
+  for ( int i=0; i<count; i++ ) {
+    StkFloat oldGain, newGain;
+    equalPowerGains( x + i * step, oldGain, newGain );
+    out[i] = oldGain * old[i] + newGain * out[i];
+  }
+}
+
+unsigned long TapDelay :: getMinimumReadDelay( void ) const
+{
+  unsigned long minimum = inputs_.size() - 1;
+  for ( unsigned int i=0; i<delays_.size(); i++ )
+    minimum = std::min( minimum, getMinimumReadDelay( i ) );
+  return minimum;
+}
+
+void TapDelay :: readBlock( unsigned int tap, StkFloat *out, unsigned long count )
+{
+  StkFloat *data[2];
+  unsigned long sizes[2];
+  unsigned int nSpans = tapSpans( tap, count, data, sizes );
+
+  StkFloat *dst = out;
+  for ( unsigned int s=0; s<nSpans; s++ ) {
+    std::memcpy( dst, data[s], sizes[s] * sizeof( StkFloat ) );
+    dst += sizes[s];
+  }
+
+  if ( !isCrossfading( tap ) ) return;
+
+  // Mix in the old read position for the part of the block still inside the crossfade.
+  unsigned long left = fadeLength_ - fadePos_[tap];
+  unsigned long fadeCount = std::min( count, left );
+  nSpans = spans( outPoint_[tap] + fadeOffset_[tap], fadeCount, data, sizes );
+
+  StkFloat *faded = out;
+  StkFloat x = fadePos_[tap] * fadeStep_;
+  for ( unsigned int s=0; s<nSpans; s++ ) {
+    int n = (int) sizes[s];
+    fadeFrom( faded, data[s], n, x );
+    faded += n;
+    x += n * fadeStep_;
+  }
+
+  // A held change starts on the sample where the crossfade in progress ends (see
+  // stepCrossfade()), fading from the current read position to its own.
+  if ( !hasPendingDelay_[tap] || pendingDelay_[tap] == delays_[tap] || count <= left ) return;
+
+  unsigned long pendingPoint = outPoint_[tap] + wrap( delays_[tap] - pendingDelay_[tap] );
+  StkFloat old[interpolationBlock];
+  for ( unsigned long i=left; i<count; ) {
+    int n = (int) std::min( count - i, (unsigned long) interpolationBlock );
+    unsigned long pos = i - left; // into the held change's crossfade
+    std::copy( out + i, out + i + n, old );
+    for ( int j=0; j<n; j++ )
+      out[i + j] = inputs_[ wrap( pendingPoint + i + j ) ];
+    if ( pos < fadeLength_ )
+      fadeFrom( out + i, old, (int) std::min( (unsigned long) n, fadeLength_ - pos ), pos * fadeStep_ );
+    i += n;
+  }
+}
+
+void TapDelay :: writeBlock( const StkFloat *in, unsigned long count )
+{
+  if ( count == 0 ) return;
+
+  StkFloat *data[2];
+  unsigned long sizes[2];
+  unsigned int nSpans = spans( inPoint_, count, data, sizes );
+
+  for ( unsigned int s=0; s<nSpans; s++ ) {
+    StkFloat *dst = data[s];
+    for ( unsigned long i=0; i<sizes[s]; i++ )
+      dst[i] = in[i] * gain_;
+    in += sizes[s];
+  }
+
+  inPoint_ = wrap( inPoint_ + count );
+  for ( unsigned int i=0; i<outPoint_.size(); i++ ) {
+    outPoint_[i] = wrap( outPoint_[i] + count );
+
+    // Same as the last tick() output: read after the last input was written.
+    lastFrame_[i] = inputs_[ wrap( outPoint_[i] - 1 ) ];
+
+    if ( isCrossfading( i ) ) stepCrossfade( i, count );
   }
 }
 
@@ -1,7 +1,7 @@
 #ifndef STK_TAPDELAY_H
 #define STK_TAPDELAY_H
 
-#include "Filter.h"
+#include "RingBuffer.h"
 
 namespace stk {
 
@@ -17,11 +17,20 @@ namespace stk {
     A non-interpolating delay line is typically used in fixed
     delay-length applications, such as for reverberation.
 
+    The storage length is rounded up to a power of two (see
+    RingBuffer), so the maximum delay can be larger than requested.
+
+    Besides the per-sample tick() functions, the taps can be read a
+    block at a time (tapSpans() and readBlock()) with the inputs
+    written afterwards by writeBlock().  Single taps can then be moved
+    with setTapDelay(), crossfading from the old read position to the
+    new one.
+
     by Perry R. Cook and Gary P. Scavone, 1995--2019.
 */
 /***************************************************/
 
-class TapDelay : public Filter
+class TapDelay : public RingBuffer
 {
  public:
 
@@ -55,6 +64,69 @@ class TapDelay : public Filter
   //! Return the current delay-line length.
   std::vector<unsigned long> getTapDelays( void ) const { return delays_; };
 
+  //! Return the number of taps.
+  unsigned int getNumTaps( void ) const { return (unsigned int) delays_.size(); };
+
+  //! Set the length of a single tap, leaving the others as they are.
+  /*!
+    The valid range for \e delay is from 0 to the maximum delay-line
+    length.  If crossfading is enabled, the tap's output fades from
+    the old read position to the new one.  A change made while the
+    tap is crossfading is held until that crossfade finishes; only
+    the most recent held value is kept.  Unlike setTapDelays(), this
+    never allocates.  The \e tap argument is only checked if
+    _STK_DEBUG_ is defined during compilation.
+  */
+  void setTapDelay( unsigned int tap, unsigned long delay );
+
+  //! Return the current length of a single tap.
+  unsigned long getTapDelay( unsigned int tap ) const { return delays_[tap]; };
+
+  //! Crossfade tap-length changes made with setTapDelay() over \e samples samples.
+  /*!
+    The crossfade is always equal-power, since the old and new read
+    positions of a tap are normally too far apart to be correlated.
+    A length of zero (the default) disables crossfading.  Any
+    crossfades in progress are finished immediately.  Crossfades are
+    only heard through readBlock() and only move on in writeBlock();
+    tick() reads from the new positions straight away.
+  */
+  void setCrossfade( unsigned long samples );
+
+  //! Return true while the given tap is crossfading to a new length.
+  bool isCrossfading( unsigned int tap ) const { return fadePos_[tap] < fadeLength_; };
+
+  //! Finish any crossfade in progress on one tap at once, jumping to its most recent length.
+  void endCrossfade( unsigned int tap );
+
+  //! Finish every crossfade in progress at once, jumping to the most recent tap lengths.
+  void endCrossfades( void );
+
+  //! Return the shortest delay currently being read by any tap, including old read positions still fading out and held changes.
+  unsigned long getMinimumReadDelay( void ) const;
+
+  //! Return the shortest delay currently being read by one tap.
+  /*!
+    This is the tap length, or the smallest of the old and new lengths
+    while the tap is crossfading, and of a held change (see
+    setTapDelay()), which a block read can already reach.
+  */
+  unsigned long getMinimumReadDelay( unsigned int tap ) const {
+    if ( !isCrossfading( tap ) ) return delays_[tap];
+    unsigned long delay = std::min( delays_[tap], fadeFromDelay_[tap] );
+    return hasPendingDelay_[tap] ? std::min( delay, pendingDelay_[tap] ) : delay;
+  };
+
+  //! Return the longest delay currently being read by one tap.
+  /*!
+    Like getMinimumReadDelay(), but the largest of the lengths.
+  */
+  unsigned long getMaximumReadDelay( unsigned int tap ) const {
+    if ( !isCrossfading( tap ) ) return delays_[tap];
+    unsigned long delay = std::max( delays_[tap], fadeFromDelay_[tap] );
+    return hasPendingDelay_[tap] ? std::max( delay, pendingDelay_[tap] ) : delay;
+  };
+
   //! Return the specified tap value of the last computed frame.
   /*!
     Use the lastFrame() function to get all tap values from the
@@ -104,12 +176,50 @@ class TapDelay : public Filter
   */
   StkFrames& tick( StkFrames& iFrames, StkFrames &oFrames, unsigned int iChannel = 0 );
 
+  //! Get the delay-line storage for the next \e count outputs of a tap, split where the delay-line wraps.
+  /*!
+    The outputs are those the next \e count calls to tick() would
+    give for this tap, from its current read position (ignoring any
+    crossfade in progress).  They are returned as at most two
+    contiguous spans in \c data and \c sizes, and the number of
+    spans used (1 or 2) is returned.  Nothing is advanced.  The
+    outputs only depend on inputs that have already been written
+    if \e count is less than or equal to the tap length.  Range
+    checking is only performed if _STK_DEBUG_ is defined during
+    compilation, in which case an out-of-range value will trigger an
+    StkError exception.
+  */
+  unsigned int tapSpans( unsigned int tap, unsigned long count, StkFloat *data[2], unsigned long sizes[2] );
+
+  //! Copy the next \e count outputs of a tap into \e out without advancing.
+  /*!
+    The outputs include any crossfade in progress on the tap, as it
+    stands now, and a held change starting on the sample where that
+    crossfade ends.
+  */
+  void readBlock( unsigned int tap, StkFloat *out, unsigned long count );
+
+  //! Write \e count inputs and advance every tap, like \e count calls to tick() with the outputs discarded.
+  void writeBlock( const StkFloat *in, unsigned long count );
+
  protected:
 
-  unsigned long inPoint_;
+  void startCrossfade( unsigned int tap, unsigned long delay );
+  void stepCrossfade( unsigned int tap, unsigned long count );
+  void fadeFrom( StkFloat *out, const StkFloat *old, int count, StkFloat x ) const;
+
   std::vector<unsigned long> outPoint_;
   std::vector<unsigned long> delays_;
 
+  // per-tap crossfade state, as in Delay
+  unsigned long fadeLength_;
+  StkFloat fadeStep_;                    // 1 / fadeLength_
+  std::vector<unsigned long> fadePos_;   // == fadeLength_ when idle
+  std::vector<unsigned long> fadeOffset_; // old read position - new read position, wrapped
+  std::vector<unsigned long> fadeFromDelay_;
+  std::vector<unsigned long> pendingDelay_;
+  std::vector<bool> hasPendingDelay_;
+
 };
 
 inline StkFloat TapDelay :: lastOut( unsigned int tap ) const
@@ -133,19 +243,14 @@ inline StkFrames& TapDelay :: tick( StkFloat input, StkFrames& outputs )
   }
 #endif
 
-  inputs_[inPoint_++] = input * gain_;
-
-  // Check for end condition
-  if ( inPoint_ == inputs_.size() )
-    inPoint_ = 0;
+  inputs_[inPoint_] = input * gain_;
+  inPoint_ = wrap( inPoint_ + 1 );
 
   // Read out next values
   StkFloat *outs = &outputs[0];
   for ( unsigned int i=0; i<outPoint_.size(); i++ ) {
-    *outs++ = inputs_[outPoint_[i]];
-    lastFrame_[i] = *outs;
-    if ( ++outPoint_[i] == inputs_.size() )
-      outPoint_[i] = 0;
+    lastFrame_[i] = *outs++ = inputs_[outPoint_[i]];
+    outPoint_[i] = wrap( outPoint_[i] + 1 );
   }
 
   return outputs;
@@ -170,11 +275,11 @@ inline StkFrames& TapDelay :: tick( StkFrames& frames, unsigned int channel )
   unsigned int iHop = frames.channels();
   std::size_t oHop = frames.channels() - outPoint_.size();
   for ( unsigned long i=0; i<frames.frames(); i++, iSamples += iHop, oSamples += oHop ) {
-    inputs_[inPoint_++] = *iSamples * gain_;
-    if ( inPoint_ == inputs_.size() ) inPoint_ = 0;
+    inputs_[inPoint_] = *iSamples * gain_;
+    inPoint_ = wrap( inPoint_ + 1 );
     for ( j=0; j<outPoint_.size(); j++ ) {
       *oSamples++ = inputs_[outPoint_[j]];
-      if ( ++outPoint_[j] == inputs_.size() ) outPoint_[j] = 0;
+      outPoint_[j] = wrap( outPoint_[j] + 1 );
     }
   }
 
@@ -202,11 +307,11 @@ inline StkFrames& TapDelay :: tick( StkFrames& iFrames, StkFrames& oFrames, unsi
   unsigned int iHop = iFrames.channels();
   std::size_t oHop = oFrames.channels() - outPoint_.size();
   for ( unsigned long i=0; i<iFrames.frames(); i++, iSamples += iHop, oSamples += oHop ) {
-    inputs_[inPoint_++] = *iSamples * gain_;
-    if ( inPoint_ == inputs_.size() ) inPoint_ = 0;
+    inputs_[inPoint_] = *iSamples * gain_;
+    inPoint_ = wrap( inPoint_ + 1 );
     for ( j=0; j<outPoint_.size(); j++ ) {
       *oSamples++ = inputs_[outPoint_[j]];
-      if ( ++outPoint_[j] == inputs_.size() ) outPoint_[j] = 0;
+      outPoint_[j] = wrap( outPoint_[j] + 1 );
     }
   }
 
@@ -215,6 +320,18 @@ inline StkFrames& TapDelay :: tick( StkFrames& iFrames, StkFrames& oFrames, unsi
   return iFrames;
 }
 
+inline unsigned int TapDelay :: tapSpans( unsigned int tap, unsigned long count, StkFloat *data[2], unsigned long sizes[2] )
+{
+#if defined(_STK_DEBUG_)
+  if ( tap >= outPoint_.size() || count > inputs_.size() ) {
+    oStream_ << "TapDelay::tapSpans(): tap or count argument is out of range!";
+    handleError( StkError::FUNCTION_ARGUMENT );
+  }
+#endif
+
+  return spans( outPoint_[tap], count, data, sizes );
+}
+
 } // stk namespace
 
 #endif
@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    TempoSync.h
+
+    Note values for the tempo-synced delay times, and their lengths at a
+    given tempo. No JUCE dependency.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "Defines.h"
+#include <algorithm>
+
+namespace TempoSync
+{
+    struct NoteValue
+    {
+        const char* name;
+        double quarterNotes; // length in quarter notes (beats)
+    };
+
+    // longest first, so the parameter's choice list reads in order
+    constexpr NoteValue noteValues[] = {
+        { "1/1",   4.0 },
+        { "1/2.",  3.0 },
+        { "1/2",   2.0 },
+        { "1/2T",  4.0/3.0 },
+        { "1/4.",  1.5 },
+        { "1/4",   1.0 },
+        { "1/4T",  2.0/3.0 },
+        { "1/8.",  0.75 },
+        { "1/8",   0.5 },
+        { "1/8T",  1.0/3.0 },
+        { "1/16.", 0.375 },
+        { "1/16",  0.25 },
+        { "1/16T", 1.0/6.0 },
+        { "1/32",  0.125 },
+    };
+    constexpr int numNoteValues = sizeof(noteValues)/sizeof(noteValues[0]);
+    constexpr int defaultNoteValue = 5; // 1/4
+
+    // length of a note value in ms at bpm, clamped to the delay time range
+    // (so e.g. a whole note at a slow tempo gets the longest delay there is)
+    inline double noteMs(int index, double bpm) {
+        index = std::min(std::max(index, 0), numNoteValues - 1);
+        double ms = noteValues[index].quarterNotes*60000.0/std::max(bpm, 1.0);
+        return std::min(std::max(ms, (double) DELAY_LENGTH_MS_MIN), (double) DELAY_LENGTH_MS_MAX);
+    }
+}
@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    WaveformView.cpp
+
+  ==============================================================================
+*/
+
+#include "WaveformView.h"
+#include <algorithm>
+#include <cmath>
+
+WaveformView::WaveformView() : displayLevel(0), columnsDrawn(0) {
+    for (int level = 0; level < numLevels; level++)
+        levels[level].bins.resize(WAVEFORM_NUM_BINS >> level);
+    for (int ch = 0; ch < numChannels; ch++) {
+        echoDelayMs[ch] = 0;
+        echoGains[ch] = 0;
+    }
+    setOpaque(true);
+    setInterceptsMouseClicks(false, false);
+}
+
+void WaveformView::addBins(const WaveformBin* bins, int numBins) {
+    for (int i = 0; i < numBins; i++)
+        addBin(0, bins[i]);
+    drawNewColumns();
+}
+
+// adds a bin to one level, and every second one merged with its neighbour to the next
+void WaveformView::addBin(int level, const WaveformBin& bin) {
+    Level& l = levels[level];
+    l.bins[l.count % l.bins.size()] = bin;
+    l.count++;
+
+    if (level + 1 < numLevels) {
+        if (l.hasPending) {
+            WaveformBin merged = l.pending;
+            merged.add(bin);
+            l.hasPending = false;
+            addBin(level + 1, merged);
+        }
+        else {
+            l.pending = bin;
+            l.hasPending = true;
+        }
+    }
+}
+
+void WaveformView::drawNewColumns() {
+    if (! image.isValid())
+        return;
+
+    const Level& l = levels[displayLevel];
+    const long long size = (long long) l.bins.size();
+    long long first = std::max(columnsDrawn, l.count - size); // older ones are overwritten anyway
+    if (first == l.count)
+        return;
+
+    juce::Graphics g(image);
+    for (long long i = first; i < l.count; i++)
+        drawColumn(g, (int) (i % size), l.bins[i % size]);
+    columnsDrawn = l.count;
+    repaint();
+}
+
+// one lane per channel, left on top
+void WaveformView::drawColumn(juce::Graphics& g, int column, const WaveformBin& bin) {
+    const int laneHeight = image.getHeight()/numChannels;
+    image.clear(juce::Rectangle<int>(column, 0, 1, image.getHeight()), juce::Colours::black);
+
+    g.setColour(juce::Colours::skyblue);
+    for (int ch = 0; ch < numChannels; ch++) {
+        float centre = (ch + 0.5f)*laneHeight;
+        float top = centre - 0.5f*laneHeight*juce::jlimit(-1.0f, 1.0f, bin.max[ch]);
+        float bottom = centre - 0.5f*laneHeight*juce::jlimit(-1.0f, 1.0f, bin.min[ch]);
+        g.fillRect((float) column, top, 1.0f, std::max(bottom - top, 1.0f));
+    }
+}
+
+void WaveformView::setEchoes(const float* delayMs, const float* feedbackGains) {
+    bool changed = false;
+    for (int ch = 0; ch < numChannels; ch++) {
+        changed = changed || delayMs[ch] != echoDelayMs[ch] || feedbackGains[ch] != echoGains[ch];
+        echoDelayMs[ch] = delayMs[ch];
+        echoGains[ch] = feedbackGains[ch];
+    }
+    if (changed)
+        repaint();
+}
+
+void WaveformView::paint(juce::Graphics& g) {
+    const int width = getWidth();
+    const int height = getHeight();
+    if (! image.isValid()) {
+        g.fillAll(juce::Colours::black);
+        return;
+    }
+
+    /* The image ring, oldest column (the next one to be overwritten) on the left */
+    const int columns = image.getWidth();
+    const int oldest = (int) (columnsDrawn % columns);
+    const int split = (int) std::round((double) (columns - oldest)*width/columns);
+    g.drawImage(image, 0, 0, split, height, oldest, 0, columns - oldest, height);
+    if (oldest > 0)
+        g.drawImage(image, split, 0, width - split, height, 0, 0, oldest, height);
+
+    /* Echo markers: the sound at k delays back has come out k - 1 times and is faded by
+       the feedback gain each time, so the marker fades the same way */
+    const float laneHeight = (float) height/numChannels;
+    for (int ch = 0; ch < numChannels; ch++) {
+        if (echoDelayMs[ch] <= 0)
+            continue;
+
+        float alpha = 1;
+        for (int k = 1; k*echoDelayMs[ch] <= DELAY_LENGTH_MS_MAX && alpha > 0.001f; k++) {
+            float x = width*(1 - k*echoDelayMs[ch]/DELAY_LENGTH_MS_MAX);
+            g.setColour(juce::Colours::orange.withAlpha(alpha));
+            g.drawLine(x, ch*laneHeight, x, (ch + 1)*laneHeight, 1.5f);
+            alpha *= echoGains[ch];
+        }
+    }
+
+    g.setColour(juce::Colours::darkgrey);
+    g.drawHorizontalLine(height/2, 0, width);
+}
+
+// picks the mip level for the new width and redraws the whole image from it
+void WaveformView::resized() {
+    const int width = getWidth();
+    const int height = getHeight();
+    if (width <= 0 || height <= 0) {
+        image = juce::Image();
+        return;
+    }
+
+    displayLevel = 0;
+    while (displayLevel + 1 < numLevels && (WAVEFORM_NUM_BINS >> displayLevel) > width)
+        displayLevel++;
+
+    image = juce::Image(juce::Image::RGB, WAVEFORM_NUM_BINS >> displayLevel, height, true);
+    image.clear(juce::Rectangle<int>(0, 0, image.getWidth(), height), juce::Colours::black);
+    columnsDrawn = 0;
+    drawNewColumns();
+}
@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    WaveformView.h
+
+    Scrolling min/max waveform of what went into the delay lines over the
+    last DELAY_LENGTH_MS_MAX, with the echoes marked at multiples of the
+    delay time.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "DelayEngine.h"
+#include "Defines.h"
+#include <vector>
+
+/* The bins from the engine are merged pairwise into mip levels of 1024, 512, 256, ...
+   bins each, as they arrive. The view draws from the finest level that has no more bins
+   than it has pixels, one image column per bin, into a cached image used as a ring: a new
+   bin only draws its own column, and paint() copies the image in two pieces (oldest part
+   first) and draws the echo markers over it. So neither adding bins nor repainting costs
+   more with a longer history. */
+class WaveformView  : public juce::Component
+{
+public:
+    WaveformView();
+
+    // bins from DelayEngine::popWaveformBin(), oldest first
+    void addBins(const WaveformBin* bins, int numBins);
+
+    // echoes are marked at every multiple of the delay, fading with the feedback gain
+    void setEchoes(const float* delayMs, const float* feedbackGains);
+
+    void paint(juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    static constexpr int numChannels = WaveformBin::numChannels;
+    static constexpr int numLevels = 6; // down to WAVEFORM_NUM_BINS/32 bins
+
+    struct Level
+    {
+        std::vector<WaveformBin> bins; // ring of WAVEFORM_NUM_BINS >> level bins
+        long long count = 0;           // bins added so far
+        WaveformBin pending;           // first bin of a pair waiting for its neighbour
+        bool hasPending = false;
+    };
+    Level levels[numLevels];
+
+    int displayLevel;
+    juce::Image image;      // one column per bin of displayLevel, used as a ring
+    long long columnsDrawn; // bins of displayLevel drawn into the image so far
+
+    float echoDelayMs[numChannels];
+    float echoGains[numChannels];
+
+    void addBin(int level, const WaveformBin& bin);
+    void drawNewColumns();
+    void drawColumn(juce::Graphics& g, int column, const WaveformBin& bin);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveformView)
+};
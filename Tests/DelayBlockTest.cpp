@@ -0,0 +1,98 @@
+/*
+  ==============================================================================
+
+    DelayBlockTest.cpp
+
+    Checks stk::Delay's block path (readBlock() then writeBlock(), the way
+    DelayEngine uses it) against tick(), while the delay length keeps
+    changing: often enough that changes are held behind crossfades in
+    progress and start part way through a block. Runs both crossfade
+    curves, the plain and the interpolated readBlock(), and several block
+    sizes, each block read one sample past its end like DelayEngine's wet
+    tap.
+
+    The outputs have to agree to within rounding (the block path steps the
+    crossfade position by adding, tick() by multiplying), and the two lines
+    have to end up in the same state after every block.
+
+  ==============================================================================
+*/
+
+#include "StkLite-4.6.1/Delay.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+const unsigned long crossfadeSamps = 80;
+const int numBlocks = 4000;
+const int blockSizes[] = { 1, 5, 17, 64, 100, 300 };
+const double tolerance = 1e-5;
+
+/* Largest output difference over one run, or -1 if the states went apart */
+double run(stk::Delay::CrossfadeCurve curve, int blockSize, bool interpolated) {
+    stk::Delay ticked(500, 4095), blocked(500, 4095);
+    ticked.setCrossfade(crossfadeSamps, curve);
+    blocked.setCrossfade(crossfadeSamps, curve);
+
+    std::mt19937 rng(blockSize);
+    std::uniform_real_distribution<float> dist(-1, 1);
+    std::uniform_int_distribution<int> delayDist(400, 900);
+    std::vector<stk::StkFloat> in(blockSize), out(blockSize + 1), noExtraDelay(blockSize + 1, 0);
+
+    double worst = 0;
+    for (int block = 0; block < numBlocks; block++) {
+        // a change every 3rd block and another every 7th, so some land while a crossfade is
+        // still going: blocks shorter than the crossfade carry one over, and on every 21st
+        // block the second change is held behind the first
+        for (int every : { 3, 7 }) {
+            if (block % every == 0) {
+                unsigned long delay = delayDist(rng);
+                ticked.setDelay(delay);
+                blocked.setDelay(delay);
+            }
+        }
+        for (stk::StkFloat& x : in)
+            x = dist(rng);
+
+        if (interpolated)
+            blocked.readBlock(out.data(), blockSize + 1, noExtraDelay.data());
+        else
+            blocked.readBlock(out.data(), blockSize + 1);
+        for (int i = 0; i < blockSize; i++) {
+            worst = std::max(worst, (double) std::abs(ticked.nextOut() - out[i]));
+            ticked.tick(in[i]);
+        }
+        worst = std::max(worst, (double) std::abs(ticked.nextOut() - out[blockSize]));
+        blocked.writeBlock(in.data(), blockSize);
+
+        if (ticked.getDelay() != blocked.getDelay() || ticked.isCrossfading() != blocked.isCrossfading())
+            return -1;
+    }
+    return worst;
+}
+
+}
+
+int main() {
+    bool ok = true;
+    for (auto curve : { stk::Delay::LINEAR, stk::Delay::EQUAL_POWER }) {
+        for (bool interpolated : { false, true }) {
+            for (int blockSize : blockSizes) {
+                double worst = run(curve, blockSize, interpolated);
+                bool passed = worst >= 0 && worst <= tolerance;
+                if (! passed)
+                    std::printf("%s, %s readBlock, block %d: %s\n", curve == stk::Delay::LINEAR ? "linear" : "equal power",
+                                interpolated ? "interpolated" : "plain", blockSize,
+                                worst < 0 ? "state differs from tick()" : "output differs from tick()");
+                ok = ok && passed;
+            }
+        }
+    }
+
+    std::printf("block path vs tick(): %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
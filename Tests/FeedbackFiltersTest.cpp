@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    FeedbackFiltersTest.cpp
+
+    Checks every lane of FeedbackFilters against what it replaces: a low pass
+    stk::BiQuad followed by a high pass one, per channel. The outputs have to
+    match exactly, sample for sample, over a range of cutoffs and host block
+    sizes (including one sample, where the first and last steps of a block
+    are the same sample).
+
+    Built three times, against the SIMD float library (FeedbackFiltersTest),
+    the scalar float one (FeedbackFiltersTestScalar, DELAY_NO_SIMD) and the
+    double one (FeedbackFiltersTestDouble). Coefficient ramps have no
+    stk::BiQuad counterpart and aren't covered.
+
+  ==============================================================================
+*/
+
+#include "FeedbackFilters.h"
+#include "Mu45FilterCalc/Mu45FilterCalc.h"
+#include "StkLite-4.6.1/BiQuad.h"
+#include "Defines.h"
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <vector>
+
+namespace {
+
+const float fs = 48000;
+const int numSamples = 1 << 16;
+const int blockSizes[] = { 1, 2, 3, 7, 64, 511, 4096 };
+
+/* Cutoffs per channel: high pass, low pass */
+struct Cutoffs
+{
+    float highPassFc[2];
+    float lowPassFc[2];
+};
+
+const Cutoffs cutoffs[] = {
+    { { LOW_CUT_DEFAULT_FC, LOW_CUT_DEFAULT_FC }, { HIGH_CUT_DEFAULT_FC, HIGH_CUT_DEFAULT_FC } },
+    { { 20, 2000 },       { 20000, 300 } },
+    { { 20000, 20 },      { 20, 20000 } },
+    { { 1000, 5000 },     { 1200, 18000 } },
+};
+
+void setBiQuad(stk::BiQuad& filter, const float* coeffs) {
+    filter.setCoefficients(coeffs[0], coeffs[1], coeffs[2], coeffs[3], coeffs[4]);
+}
+
+/* Number of samples where the two differ, over one render */
+long mismatches(const Cutoffs& c, int blockSize, const std::vector<stk::StkFloat>* input) {
+    FeedbackFilters filters;
+    stk::BiQuad lowPass[2], highPass[2];
+    float coeffs[5];
+    for (int ch = 0; ch < 2; ch++) {
+        Mu45FilterCalc::calcCoeffsLPF(coeffs, c.lowPassFc[ch], HIGH_CUT_Q, fs);
+        filters.setLowPassCoeffs(ch, coeffs);
+        setBiQuad(lowPass[ch], coeffs);
+        Mu45FilterCalc::calcCoeffsHPF(coeffs, c.highPassFc[ch], LOW_CUT_Q, fs);
+        filters.setHighPassCoeffs(ch, coeffs);
+        setBiQuad(highPass[ch], coeffs);
+    }
+
+    std::vector<stk::StkFloat> out[2] = { input[0], input[1] };
+    for (int pos = 0; pos < numSamples; pos += blockSize)
+        filters.process(out[0].data() + pos, out[1].data() + pos, std::min(blockSize, numSamples - pos));
+
+    long count = 0;
+    for (int ch = 0; ch < 2; ch++)
+        for (int i = 0; i < numSamples; i++)
+            count += out[ch][i] != highPass[ch].tick(lowPass[ch].tick(input[ch][i]));
+    return count;
+}
+
+}
+
+int main() {
+    std::vector<stk::StkFloat> input[2];
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-1, 1);
+    for (auto& channel : input) {
+        channel.resize(numSamples);
+        for (stk::StkFloat& x : channel)
+            x = dist(rng);
+    }
+
+    // FeedbackFilters only has SIMD kernels for floats
+#if defined(DELAY_NO_SIMD)
+    const bool simd = false;
+#else
+    const bool simd = sizeof(stk::StkFloat) == sizeof(float);
+#endif
+    std::printf("StkFloat is a %s, %s kernel\n", sizeof(stk::StkFloat) == sizeof(float) ? "float" : "double",
+                simd ? "SIMD" : "scalar");
+
+    bool ok = true;
+    for (const Cutoffs& c : cutoffs) {
+        for (int blockSize : blockSizes) {
+            long count = mismatches(c, blockSize, input);
+            if (count > 0)
+                std::printf("LP %g/%g Hz, HP %g/%g Hz, block %d: %ld mismatches\n", c.lowPassFc[0], c.lowPassFc[1],
+                            c.highPassFc[0], c.highPassFc[1], blockSize, count);
+            ok = ok && count == 0;
+        }
+    }
+
+    std::printf("%d cutoff sets x %d block sizes, %d samples per channel: %s\n", (int) std::size(cutoffs),
+                (int) std::size(blockSizes), numSamples, ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
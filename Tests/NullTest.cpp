@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    NullTest.cpp
+
+    Null test of the single-precision build against the double one: the same
+    renders through DelayEngine with StkFloat as a float (_STK_FLOAT32_, what
+    the plugin ships) and as a double, subtracted. Each render is 30 s of a
+    0.5 s noise burst at 48 kHz, 150/170 ms, fully wet, at four filter and
+    feedback settings.
+
+    The program is built once per precision (NullTest and NullTestDouble).
+    One build writes its renders, the other reads them back and reports the
+    residual of each setting: the peak difference relative to the peak of
+    the reference. It fails if any of them is above maxResidualDb.
+
+    Usage:
+      NullTestDouble --write double.raw
+      NullTest double.raw
+
+  ==============================================================================
+*/
+
+#include "DelayEngine.h"
+#include "FeedbackGain.h"
+#include "Mu45FilterCalc/Mu45FilterCalc.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64)
+ #include <xmmintrin.h>
+#endif
+
+namespace {
+
+const double fs = 48000;
+const int blockSize = 512;
+const double seconds = 30;
+const double burstSeconds = 0.5;
+const float delayMs[2] = { 150, 170 };
+
+// near-unity loop gain keeps rounding errors circulating, so the worst case is around -70 dB
+const double maxResidualDb = -60;
+
+struct Setting
+{
+    const char* name;
+    float highPassFc;
+    float lowPassFc;
+    float feedback; // %
+};
+
+const Setting settings[] = {
+    { "LC 200 Hz, HC 5 kHz,  FB 50%",  200,  5000,  50 },
+    { "LC 20 Hz,  HC 200 Hz, FB 90%",  20,   200,   90 },
+    { "LC 2 kHz,  HC 20 kHz, FB 100%", 2000, 20000, 100 },
+    { "LC 20 Hz,  HC 20 kHz, FB 100%", 20,   20000, 100 },
+};
+const int numSettings = sizeof(settings)/sizeof(settings[0]);
+
+/* Both channels of one render, one after the other */
+std::vector<float> render(const Setting& setting) {
+    const int numSamples = (int) (seconds*fs);
+    std::vector<float> out(2*numSamples, 0.0f);
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+    for (int ch = 0; ch < 2; ch++)
+        for (int i = 0; i < (int) (burstSeconds*fs); i++)
+            out[ch*numSamples + i] = dist(rng);
+
+    DelayEngine engine;
+    engine.prepare(fs, blockSize);
+    float coeffs[5];
+    for (int ch = 0; ch < 2; ch++) {
+        Mu45FilterCalc::calcCoeffsHPF(coeffs, setting.highPassFc, LOW_CUT_Q, fs);
+        engine.setHighPassCoeffs(ch, coeffs);
+        Mu45FilterCalc::calcCoeffsLPF(coeffs, setting.lowPassFc, HIGH_CUT_Q, fs);
+        engine.setLowPassCoeffs(ch, coeffs);
+        engine.setWetDryGains(ch, 1, 0);
+        engine.setDelaySamps(ch, std::ceil(delayMs[ch]*(fs/1000.0)));
+        engine.setFeedbackGain(ch, determineFeedbackGain(setting.feedback));
+    }
+
+    for (int pos = 0; pos < numSamples; pos += blockSize) {
+        float* block[2] = { out.data() + pos, out.data() + numSamples + pos };
+        engine.process(block, std::min(blockSize, numSamples - pos));
+    }
+    return out;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const char* writePath = nullptr;
+    const char* referencePath = nullptr;
+    if (argc == 3 && std::strcmp(argv[1], "--write") == 0)
+        writePath = argv[2];
+    else if (argc == 2)
+        referencePath = argv[1];
+    else {
+        std::fprintf(stderr, "usage: NullTest --write <file> | NullTest <reference file>\n");
+        return 1;
+    }
+
+#if defined(__SSE__) || defined(_M_X64)
+    _mm_setcsr(_mm_getcsr() | 0x8040); // flush denormals to zero, like ScopedNoDenormals in processBlock
+#endif
+
+    const char* precision = sizeof(stk::StkFloat) == sizeof(float) ? "float" : "double";
+    std::FILE* file = std::fopen(writePath ? writePath : referencePath, writePath ? "wb" : "rb");
+    if (! file) {
+        std::fprintf(stderr, "can't open %s\n", writePath ? writePath : referencePath);
+        return 1;
+    }
+
+    bool ok = true;
+    for (const Setting& setting : settings) {
+        std::vector<float> out = render(setting);
+        if (writePath) {
+            ok = ok && std::fwrite(out.data(), sizeof(float), out.size(), file) == out.size();
+            continue;
+        }
+
+        std::vector<float> reference(out.size());
+        if (std::fread(reference.data(), sizeof(float), reference.size(), file) != reference.size()) {
+            std::fprintf(stderr, "%s is too short\n", referencePath);
+            ok = false;
+            break;
+        }
+        float peak = 0, peakDiff = 0;
+        for (size_t i = 0; i < out.size(); i++) {
+            peak = std::max(peak, std::abs(reference[i]));
+            peakDiff = std::max(peakDiff, std::abs(out[i] - reference[i]));
+        }
+        double residualDb = peakDiff > 0 ? 20*std::log10(peakDiff/peak) : -INFINITY;
+        bool passed = residualDb <= maxResidualDb;
+        std::printf("%-32s residual %7.1f dB%s\n", setting.name, residualDb, passed ? "" : "  FAILED");
+        ok = ok && passed;
+    }
+    std::fclose(file);
+
+    if (writePath)
+        std::printf("%s renders written to %s%s\n", precision, writePath, ok ? "" : " (FAILED)");
+    else
+        std::printf("%s build vs %s: %s\n", precision, referencePath, ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
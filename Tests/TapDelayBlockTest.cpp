@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    TapDelayBlockTest.cpp
+
+    Checks that stk::TapDelay's block path (readBlock() of every tap, then
+    writeBlock(), the way MultiTapDelay uses it) doesn't depend on the block
+    size, while the tap lengths keep changing: often enough that changes are
+    held behind crossfades in progress and start part way through a block.
+    tick() ignores crossfades, so the reference is the same render one
+    sample at a time.
+
+    The tap lengths change at the same sample positions in every render, a
+    block ending early where one is due (like MultiTapDelay's chunks). The
+    outputs have to agree to within rounding (a longer block steps the
+    crossfade position by adding, a shorter one starts over from it more
+    often), and the lines have to end up in the same state.
+
+  ==============================================================================
+*/
+
+#include "StkLite-4.6.1/TapDelay.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+namespace {
+
+const unsigned long crossfadeSamps = 100;
+const unsigned int numTaps = 3;
+const unsigned long numSamples = 100000;
+const int blockSizes[] = { 1, 17, 64, 300 };
+const double tolerance = 1e-5;
+
+/* Every tap's output over one render, one tap after the other, and where the taps ended up */
+struct Render
+{
+    std::vector<stk::StkFloat> out;
+    std::vector<unsigned long> delays;
+    std::vector<bool> crossfading;
+};
+
+Render render(int blockSize) {
+    stk::TapDelay delay(std::vector<unsigned long>(numTaps, 500), 4095);
+    delay.setCrossfade(crossfadeSamps);
+
+    std::mt19937 rng(1);
+    std::uniform_real_distribution<float> dist(-1, 1);
+    std::uniform_int_distribution<int> delayDist(400, 900);
+    // gaps shorter than the crossfade hold the next change behind the one in progress,
+    // and a third of the changes are followed straight away by another, which is held
+    std::uniform_int_distribution<unsigned long> gapDist(20, 400);
+    std::uniform_int_distribution<int> repeatDist(0, 2);
+
+    std::vector<stk::StkFloat> in(numSamples);
+    Render r;
+    r.out.resize(numTaps*numSamples);
+    for (stk::StkFloat& x : in)
+        x = dist(rng);
+
+    unsigned long nextChange = 0;
+    for (unsigned long pos = 0; pos < numSamples;) {
+        if (pos == nextChange) {
+            for (int i = repeatDist(rng) == 0 ? 2 : 1; i > 0; i--)
+                for (unsigned int tap = 0; tap < numTaps; tap++)
+                    delay.setTapDelay(tap, delayDist(rng));
+            nextChange += gapDist(rng);
+        }
+
+        unsigned long count = std::min({ (unsigned long) blockSize, nextChange - pos, numSamples - pos });
+        for (unsigned int tap = 0; tap < numTaps; tap++)
+            delay.readBlock(tap, r.out.data() + tap*numSamples + pos, count);
+        delay.writeBlock(in.data() + pos, count);
+        pos += count;
+    }
+
+    for (unsigned int tap = 0; tap < numTaps; tap++) {
+        r.delays.push_back(delay.getTapDelay(tap));
+        r.crossfading.push_back(delay.isCrossfading(tap));
+    }
+    return r;
+}
+
+}
+
+int main() {
+    Render reference = render(blockSizes[0]);
+
+    bool ok = true;
+    for (int blockSize : blockSizes) {
+        Render r = render(blockSize);
+        double worst = 0;
+        for (unsigned long i = 0; i < r.out.size(); i++)
+            worst = std::max(worst, (double) std::abs(r.out[i] - reference.out[i]));
+        bool sameState = r.delays == reference.delays && r.crossfading == reference.crossfading;
+        bool passed = sameState && worst <= tolerance;
+        if (! passed)
+            std::printf("block %d: %s\n", blockSize, sameState ? "output differs from block 1" : "state differs from block 1");
+        ok = ok && passed;
+    }
+
+    std::printf("block sizes vs one sample at a time: %s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,302 @@
+/*
+  ==============================================================================
+
+    DelayRender.cpp
+
+    Headless offline renderer: runs ColemanJP03DelayAudioProcessor (without
+    its editor) over a WAV/AIFF file and writes the result, timing every
+    processBlock call.
+
+    Usage:
+      DelayRender <input.wav|aif> <output.wav|aif> [options]
+
+      --block N[,N...]   host block sizes to render with (default 512). The
+                         output file comes from the first one, the others
+                         are timed only.
+      --param id=value   set a parameter by ID in its own units, e.g.
+                         leftDelayMs=300 or matchLR=1. Can be repeated.
+      --tail seconds     silence rendered after the input (default: the
+                         processor's getTailLengthSeconds(), at most 60 s,
+                         which is also what an endless tail gets)
+      --bits N           output bit depth (default: the input's)
+      --timings file     write every block's processing time to a CSV file
+
+    Build: compiles PluginProcessor.cpp with DELAY_HEADLESS=1, which leaves
+    out the editor and its components, and links the DSP library with
+    juce_audio_processors and juce_audio_formats (see the CMake build).
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "PluginProcessor.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+struct Options
+{
+    juce::File input;
+    juce::File output;
+    std::vector<int> blockSizes;
+    std::vector<std::pair<juce::String, float>> params;
+    double tailSeconds = -1; // < 0: ask the processor
+    int bitsPerSample = 0;   // 0: same as the input
+    juce::File timingsFile;
+    bool writeTimings = false;
+};
+
+struct RenderStats
+{
+    int blockSize = 0;
+    juce::int64 numSamples = 0;
+    std::vector<double> blockNs; // processBlock time for each block
+};
+
+void printUsage() {
+    std::fprintf(stderr,
+                 "usage: DelayRender <input.wav|aif> <output.wav|aif> [--block N[,N...]]\n"
+                 "                   [--param id=value]... [--tail seconds] [--bits N] [--timings file.csv]\n");
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    if (argc < 3)
+        return false;
+
+    options.input = juce::File::getCurrentWorkingDirectory().getChildFile(argv[1]);
+    options.output = juce::File::getCurrentWorkingDirectory().getChildFile(argv[2]);
+
+    for (int i = 3; i < argc; i++) {
+        juce::String arg(argv[i]);
+        if (i + 1 >= argc) {
+            std::fprintf(stderr, "missing value for %s\n", argv[i]);
+            return false;
+        }
+        juce::String value(argv[++i]);
+
+        if (arg == "--block") {
+            juce::StringArray sizes;
+            sizes.addTokens(value, ",", "");
+            for (auto& size : sizes) {
+                if (size.getIntValue() <= 0) {
+                    std::fprintf(stderr, "bad block size: %s\n", size.toRawUTF8());
+                    return false;
+                }
+                options.blockSizes.push_back(size.getIntValue());
+            }
+        }
+        else if (arg == "--param") {
+            if (! value.contains("=")) {
+                std::fprintf(stderr, "expected id=value, got %s\n", value.toRawUTF8());
+                return false;
+            }
+            options.params.push_back({ value.upToFirstOccurrenceOf("=", false, false),
+                                       value.fromFirstOccurrenceOf("=", false, false).getFloatValue() });
+        }
+        else if (arg == "--tail") {
+            options.tailSeconds = std::max(0.0, value.getDoubleValue());
+        }
+        else if (arg == "--bits") {
+            options.bitsPerSample = value.getIntValue();
+        }
+        else if (arg == "--timings") {
+            options.timingsFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+            options.writeTimings = true;
+        }
+        else {
+            std::fprintf(stderr, "unknown option: %s\n", arg.toRawUTF8());
+            return false;
+        }
+    }
+
+    if (options.blockSizes.empty())
+        options.blockSizes.push_back(512);
+    return true;
+}
+
+// Sets parameters by ID, in the units shown to the user (ms, %, Hz, 0/1)
+bool applyParams(juce::AudioProcessor& processor, const Options& options) {
+    for (auto& param : options.params) {
+        juce::RangedAudioParameter* found = nullptr;
+        for (auto* p : processor.getParameters())
+            if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(p))
+                if (ranged->paramID == param.first)
+                    found = ranged;
+
+        if (found == nullptr) {
+            std::fprintf(stderr, "unknown parameter: %s\n", param.first.toRawUTF8());
+            return false;
+        }
+        found->setValueNotifyingHost(found->convertTo0to1(param.second));
+    }
+    return true;
+}
+
+std::unique_ptr<juce::AudioFormatWriter> createWriter(juce::AudioFormatManager& formats, const juce::File& file,
+                                                      double sampleRate, int numChannels, int bitsPerSample) {
+    auto* format = formats.findFormatForFileExtension(file.getFileExtension());
+    if (format == nullptr)
+        return nullptr;
+
+    file.deleteFile();
+    std::unique_ptr<juce::FileOutputStream> stream = file.createOutputStream();
+    if (stream == nullptr)
+        return nullptr;
+
+    std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(), sampleRate,
+                                                                           (unsigned int) numChannels,
+                                                                           bitsPerSample, {}, 0));
+    if (writer != nullptr)
+        stream.release(); // the writer owns it now
+    return writer;
+}
+
+/* Streams the whole file (plus tail) through a fresh processor, one host block at a time */
+bool render(juce::AudioFormatReader& reader, const Options& options, int blockSize,
+            juce::AudioFormatWriter* writer, RenderStats& stats) {
+    ColemanJP03DelayAudioProcessor processor;
+    const int numChannels = 2;
+    const double sampleRate = reader.sampleRate;
+
+    if (! applyParams(processor, options))
+        return false;
+
+    processor.setNonRealtime(true);
+    processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+    processor.prepareToPlay(sampleRate, blockSize);
+
+    const double maxTailSeconds = 60; // infinite at 100% feedback
+    double tailSeconds = options.tailSeconds >= 0 ? options.tailSeconds
+                                                  : std::min(processor.getTailLengthSeconds(), maxTailSeconds);
+    juce::int64 inputLength = reader.lengthInSamples;
+    juce::int64 totalLength = inputLength + (juce::int64) std::ceil(tailSeconds*sampleRate);
+
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    stats.blockSize = blockSize;
+    stats.numSamples = totalLength;
+    stats.blockNs.clear();
+    stats.blockNs.reserve((size_t) (totalLength/blockSize + 1));
+
+    for (juce::int64 pos = 0; pos < totalLength; pos += blockSize) {
+        int numSamples = (int) std::min<juce::int64>(blockSize, totalLength - pos);
+        buffer.setSize(numChannels, numSamples, false, false, true);
+        buffer.clear();
+
+        // reads past the end of the input come back as silence
+        if (pos < inputLength)
+            reader.read(&buffer, 0, numSamples, pos, true, true);
+        if (reader.numChannels == 1)
+            buffer.copyFrom(1, 0, buffer, 0, 0, numSamples);
+
+        auto start = std::chrono::steady_clock::now();
+        processor.processBlock(buffer, midi);
+        auto end = std::chrono::steady_clock::now();
+        stats.blockNs.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+
+        if (writer != nullptr && ! writer->writeFromAudioSampleBuffer(buffer, 0, numSamples)) {
+            std::fprintf(stderr, "failed writing %s\n", options.output.getFullPathName().toRawUTF8());
+            return false;
+        }
+    }
+
+    processor.releaseResources();
+    return true;
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty())
+        return 0;
+    size_t index = std::min(values.size() - 1, (size_t) (p*(values.size() - 1) + 0.5));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+void report(const RenderStats& stats, double sampleRate) {
+    double totalNs = 0;
+    for (double ns : stats.blockNs)
+        totalNs += ns;
+
+    double audioSeconds = stats.numSamples/sampleRate;
+    double blockDeadlineNs = stats.blockSize/sampleRate*1e9;
+    std::printf("block %5d: %8.1fx real time, %7.2f ns/sample | block us: min %.2f  median %.2f  p99 %.2f  max %.2f"
+                "  (deadline %.1f)\n",
+                stats.blockSize,
+                audioSeconds/(totalNs*1e-9),
+                totalNs/(stats.numSamples*2.0),
+                percentile(stats.blockNs, 0)*1e-3,
+                percentile(stats.blockNs, 0.5)*1e-3,
+                percentile(stats.blockNs, 0.99)*1e-3,
+                percentile(stats.blockNs, 1)*1e-3,
+                blockDeadlineNs*1e-3);
+}
+
+bool writeTimings(const juce::File& file, const std::vector<RenderStats>& allStats) {
+    std::ofstream out(file.getFullPathName().toStdString());
+    if (! out)
+        return false;
+
+    out << "block_size,block_index,ns\n";
+    for (auto& stats : allStats)
+        for (size_t i = 0; i < stats.blockNs.size(); i++)
+            out << stats.blockSize << "," << i << "," << stats.blockNs[i] << "\n";
+    return (bool) out;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (! parseOptions(argc, argv, options)) {
+        printUsage();
+        return 1;
+    }
+
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; // the processor's parameters expect a message manager
+
+    juce::AudioFormatManager formats;
+    formats.registerBasicFormats();
+
+    std::unique_ptr<juce::AudioFormatReader> reader(formats.createReaderFor(options.input));
+    if (reader == nullptr) {
+        std::fprintf(stderr, "can't read %s\n", options.input.getFullPathName().toRawUTF8());
+        return 1;
+    }
+    if (reader->numChannels < 1 || reader->numChannels > 2) {
+        std::fprintf(stderr, "only mono and stereo input is supported\n");
+        return 1;
+    }
+
+    int bits = options.bitsPerSample > 0 ? options.bitsPerSample : (int) reader->bitsPerSample;
+    auto writer = createWriter(formats, options.output, reader->sampleRate, 2, bits);
+    if (writer == nullptr) {
+        std::fprintf(stderr, "can't write %s\n", options.output.getFullPathName().toRawUTF8());
+        return 1;
+    }
+
+    std::printf("%s: %.0f Hz, %d ch, %.2f s\n", options.input.getFullPathName().toRawUTF8(),
+                reader->sampleRate, (int) reader->numChannels, reader->lengthInSamples/reader->sampleRate);
+
+    std::vector<RenderStats> allStats(options.blockSizes.size());
+    for (size_t i = 0; i < options.blockSizes.size(); i++) {
+        // only the first block size is written out
+        if (! render(*reader, options, options.blockSizes[i], i == 0 ? writer.get() : nullptr, allStats[i]))
+            return 1;
+        if (i == 0)
+            writer.reset(); // flushes the file
+
+        report(allStats[i], reader->sampleRate);
+    }
+
+    if (options.writeTimings && ! writeTimings(options.timingsFile, allStats)) {
+        std::fprintf(stderr, "can't write %s\n", options.timingsFile.getFullPathName().toRawUTF8());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,228 @@
+/*
+  ==============================================================================
+
+    RenderCorpus.cpp
+
+    A fixed set of representative renders through the DSP core, without
+    JUCE: short and long delays, full feedback, extreme filter settings,
+    parameter automation, ping-pong, the multi-tap mode, saturation and
+    oversampling, at several sample rates and host block sizes.
+    Parameters go through the same conversions calcAlgorithmParams() does
+    (Mu45FilterCalc for the filters, the dB feedback curve, ms to samples),
+    once per host block.
+
+    It is the training run for the PGO build (see Tools/pgo.sh) and the
+    timing used to compare builds.
+
+    Usage:
+      RenderCorpus [--runs N] [--seconds s] [--quiet]
+
+      --runs N      render the corpus N times and report the fastest (default 1)
+      --seconds s   length of each render (default 4)
+      --quiet       only print the total
+
+  ==============================================================================
+*/
+
+#include "DelayEngine.h"
+#include "FeedbackGain.h"
+#include "Mu45FilterCalc/Mu45FilterCalc.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <random>
+#include <vector>
+
+#if defined(__SSE__) || defined(_M_X64)
+ #include <xmmintrin.h>
+#endif
+
+namespace {
+
+const double sampleRates[] = { 44100, 48000, 96000, 192000 };
+const int blockSizes[] = { 32, 128, 512, 2048 };
+
+/* User-facing parameter values, per channel (left, right) */
+struct Settings
+{
+    float delayMs[2];
+    float feedback[2]; // %
+    float dryWet[2];   // %
+    float highPassFc[2];
+    float lowPassFc[2];
+};
+
+struct Scenario
+{
+    const char* name;
+    Settings settings;
+    bool automate; // sweep every parameter over the render
+    int numTaps;   // multi-tap mode with this many taps, spread up to the left delay time; 0 for stereo
+    float crossFeed; // %
+    bool pingPong;
+    float modDepthMs; // 0 for no modulation
+    float modRateHz;
+    int oversampling; // 1, 2 or 4
+    float saturationDriveDb; // 0 for no saturation
+};
+
+const Scenario scenarios[] = {
+    { "short",           { { 50, 63 },     { 30, 30 },   { 50, 50 }, { 200, 200 },     { 5000, 5000 } },   false, 0, 0, false, 0, 0, 1, 0 },
+    { "long",            { { 2000, 1750 }, { 60, 60 },   { 50, 50 }, { 200, 200 },     { 5000, 5000 } },   false, 0, 0, false, 0, 0, 1, 0 },
+    { "high feedback",   { { 375, 500 },   { 100, 95 },  { 70, 70 }, { 200, 200 },     { 5000, 5000 } },   false, 0, 0, false, 0, 0, 1, 0 },
+    { "filters closed",  { { 150, 150 },   { 80, 80 },   { 50, 50 }, { 20000, 20000 }, { 20, 20 } },       false, 0, 0, false, 0, 0, 1, 0 },
+    { "filters open",    { { 150, 225 },   { 80, 80 },   { 50, 50 }, { 20, 20 },       { 20000, 20000 } }, false, 0, 0, false, 0, 0, 1, 0 },
+    { "automation",      { { 100, 120 },   { 40, 40 },   { 30, 30 }, { 100, 100 },     { 2000, 2000 } },   true,  0, 0, false, 0, 0, 1, 0 },
+    { "ping-pong",       { { 375, 375 },   { 70, 70 },   { 50, 50 }, { 200, 200 },     { 5000, 5000 } },   false, 0, 100, true, 0, 0, 1, 0 },
+    { "cross-feed",      { { 375, 500 },   { 80, 80 },   { 50, 50 }, { 200, 200 },     { 5000, 5000 } },   false, 0, 40, false, 0, 0, 1, 0 },
+    { "modulated",       { { 375, 500 },   { 70, 70 },   { 50, 50 }, { 200, 200 },     { 5000, 5000 } },   false, 0, 0, false, 4, 1, 1, 0 },
+    { "oversampled 4x",  { { 375, 500 },   { 90, 90 },   { 50, 50 }, { 200, 200 },     { 5000, 5000 } },   false, 0, 0, false, 4, 1, 4, 0 },
+    { "saturated",       { { 375, 500 },   { 100, 100 }, { 50, 50 }, { 100, 100 },     { 2000, 2000 } },   true,  0, 20, false, 0, 0, 1, 12 },
+    { "multi-tap 4",     { { 500, 500 },   { 70, 70 },   { 50, 50 }, { 200, 200 },     { 5000, 5000 } },   false, 4, 0, false, 0, 0, 1, 0 },
+    { "multi-tap 16",    { { 1000, 1000 }, { 40, 40 },   { 30, 30 }, { 100, 100 },     { 2000, 2000 } },   true,  MULTITAP_NUM_TAPS_MAX, 0, false, 0, 0, 1, 0 },
+};
+
+/* Drum-like noise bursts every half second over a quiet sine, with silent gaps
+   so the feedback tails decay on their own too */
+std::vector<float> makeInput(double fs, int numSamples, unsigned seed) {
+    std::vector<float> input(numSamples);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-1, 1);
+    int period = (int) (0.5*fs);
+    for (int i = 0; i < numSamples; i++) {
+        int t = i % period;
+        float burst = std::exp(-t/(0.03f*(float) fs))*dist(rng);
+        float tone = (i/period) % 4 == 3 ? 0 : 0.05f*std::sin(2*M_PI*220*i/fs);
+        input[i] = 0.5f*burst + tone;
+    }
+    return input;
+}
+
+/* Parameter values at a point in the render, with the sweeps applied */
+Settings settingsAt(const Scenario& scenario, double progress) {
+    Settings s = scenario.settings;
+    if (! scenario.automate)
+        return s;
+
+    double lfo = 0.5 - 0.5*std::cos(2*M_PI*3*progress); // three slow sweeps over the render
+    for (int ch = 0; ch < 2; ch++) {
+        s.delayMs[ch] += (float) (900*lfo);
+        s.feedback[ch] += (float) (50*lfo);
+        s.dryWet[ch] += (float) (60*lfo);
+        s.highPassFc[ch] *= (float) std::pow(20, lfo);
+        s.lowPassFc[ch] *= (float) std::pow(8, lfo);
+    }
+    return s;
+}
+
+/* One render: a fresh engine, parameters updated once per host block like calcAlgorithmParams() */
+double render(const Scenario& scenario, double fs, int blockSize, double seconds, float& checksum) {
+    const int numSamples = (int) (seconds*fs);
+    std::vector<float> channels[2] = { makeInput(fs, numSamples, 1), makeInput(fs, numSamples, 2) };
+
+    DelayEngine engine;
+    engine.prepare(fs, blockSize, scenario.oversampling);
+    fs *= engine.getOversampling(); // the engine's rate, which every conversion below is at
+    if (scenario.numTaps > 0)
+        engine.setMode(DelayEngine::multiTap);
+    engine.setCrossFeed(scenario.crossFeed/100.0);
+    engine.setPingPong(scenario.pingPong);
+    engine.setModDepth(scenario.modDepthMs*(fs/1000.0));
+    engine.setModRate(scenario.modRateHz/fs);
+    engine.setSaturation(scenario.saturationDriveDb > 0);
+    engine.setSaturationDrive(std::pow(10, scenario.saturationDriveDb/20.0));
+    Settings last = { { -1, -1 }, { -1, -1 }, { -1, -1 }, { -1, -1 }, { -1, -1 } }; // everything is set on the first block
+
+    auto start = std::chrono::steady_clock::now();
+    for (int pos = 0; pos < numSamples; pos += blockSize) {
+        int n = std::min(blockSize, numSamples - pos);
+        Settings s = settingsAt(scenario, (double) pos/numSamples);
+        float coeffs[5];
+
+        for (int ch = 0; ch < 2; ch++) {
+            if (s.highPassFc[ch] != last.highPassFc[ch]) {
+                Mu45FilterCalc::calcCoeffsHPF(coeffs, s.highPassFc[ch], LOW_CUT_Q, fs);
+                engine.setHighPassCoeffs(ch, coeffs);
+            }
+            if (s.lowPassFc[ch] != last.lowPassFc[ch]) {
+                Mu45FilterCalc::calcCoeffsLPF(coeffs, s.lowPassFc[ch], HIGH_CUT_Q, fs);
+                engine.setLowPassCoeffs(ch, coeffs);
+            }
+            if (s.dryWet[ch] != last.dryWet[ch])
+                engine.setWetDryGains(ch, s.dryWet[ch]/100.0, 1 - s.dryWet[ch]/100.0);
+            if (s.delayMs[ch] != last.delayMs[ch])
+                engine.setDelaySamps(ch, std::ceil(s.delayMs[ch]*(fs/1000.0)));
+            if (s.feedback[ch] != last.feedback[ch])
+                engine.setFeedbackGain(ch, determineFeedbackGain(s.feedback[ch]));
+        }
+
+        // evenly spaced taps fanned out across the stereo field, the first one repeating
+        if (scenario.numTaps > 0 && s.delayMs[0] != last.delayMs[0])
+            for (int tap = 0; tap < scenario.numTaps; tap++)
+                engine.setTap(tap, std::ceil(s.delayMs[0]*(tap + 1)/scenario.numTaps*(fs/1000.0)),
+                              0.7f - 0.3f*tap/scenario.numTaps, tap % 2 ? 0.8f : -0.8f, tap == 0);
+        last = s;
+
+        float* block[2] = { channels[0].data() + pos, channels[1].data() + pos };
+        engine.process(block, n);
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    for (int ch = 0; ch < 2; ch++)
+        for (int i = 0; i < numSamples; i += 97)
+            checksum += channels[ch][i];
+    return std::chrono::duration<double, std::nano>(end - start).count()/(2.0*numSamples);
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    int runs = 1;
+    double seconds = 4;
+    bool quiet = false;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 < argc && std::strcmp(argv[i], "--runs") == 0)
+            runs = std::max(1, std::atoi(argv[++i]));
+        else if (i + 1 < argc && std::strcmp(argv[i], "--seconds") == 0)
+            seconds = std::max(0.1, std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--quiet") == 0)
+            quiet = true;
+        else {
+            std::fprintf(stderr, "usage: RenderCorpus [--runs N] [--seconds s] [--quiet]\n");
+            return 1;
+        }
+    }
+
+#if defined(__SSE__) || defined(_M_X64)
+    _mm_setcsr(_mm_getcsr() | 0x8040); // flush denormals to zero, like ScopedNoDenormals in processBlock
+#endif
+
+    const int numScenarios = sizeof(scenarios)/sizeof(scenarios[0]);
+    std::vector<double> best(numScenarios, 1e30);
+    double bestTotal = 1e30;
+    float checksum = 0;
+
+    for (int run = 0; run < runs; run++) {
+        double total = 0;
+        for (int s = 0; s < numScenarios; s++) {
+            double scenarioNs = 0;
+            for (double fs : sampleRates)
+                for (int blockSize : blockSizes)
+                    scenarioNs += render(scenarios[s], fs, blockSize, seconds, checksum);
+            scenarioNs /= std::size(sampleRates)*std::size(blockSizes);
+            best[s] = std::min(best[s], scenarioNs);
+            total += scenarioNs;
+        }
+        bestTotal = std::min(bestTotal, total/numScenarios);
+    }
+
+    if (! quiet)
+        for (int s = 0; s < numScenarios; s++)
+            std::printf("%-16s %8.3f ns/sample\n", scenarios[s].name, best[s]);
+    std::printf("total %.3f ns/sample (checksum %g)\n", bestTotal, checksum);
+    return 0;
+}
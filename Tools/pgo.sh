@@ -0,0 +1,81 @@
+#!/usr/bin/env bash
+#
+# Profile-guided build of the DSP core, without a DAW:
+#
+#   1. builds the native-lto preset as the baseline
+#   2. builds the pgo-generate preset (instrumented) and trains it on
+#      RenderCorpus, plus DelayRender over /audiotests when JUCE is available
+#   3. rebuilds the same tree with the pgo-use preset
+#   4. times RenderCorpus in both builds and reports the speedup
+#
+# Usage: Tools/pgo.sh   (from anywhere; PGO_RUNS sets the timing runs, default 5)
+#
+# The optimized binaries end up in build/pgo.
+
+set -euo pipefail
+cd "$(dirname "$0")/.."
+
+jobs=$(nproc 2>/dev/null || sysctl -n hw.ncpu)
+runs=${PGO_RUNS:-5}
+profile_dir=build/pgo/pgo-profile
+
+build() {
+    cmake --preset "$1" > /dev/null
+    cmake --build --preset "$1" -j"$jobs" > /dev/null
+}
+
+corpus_ns() {
+    "$1/RenderCorpus" --runs "$runs" --seconds 1 --quiet | sed -n 's/^total \([0-9.]*\) .*/\1/p'
+}
+
+find_render() {
+    find "$1" -path '*DelayRender_artefacts*' -name DelayRender -type f -perm -u+x 2> /dev/null | head -n 1
+}
+
+echo "== baseline build (native-lto)"
+build native-lto
+
+echo "== instrumented build (pgo-generate)"
+build pgo-generate
+rm -rf "$profile_dir" # a profile from older sources would only be partly used
+
+echo "== training"
+build/pgo/RenderCorpus --seconds 2 > /dev/null
+
+render=$(find_render build/pgo)
+if [ -n "$render" ]; then
+    # the whole processBlock path, including calcAlgorithmParams
+    for input in audiotests/*.wav; do
+        for params in "leftDelayMs=50 rightDelayMs=60 leftFeedback=20" \
+                      "leftDelayMs=2000 rightDelayMs=1500 leftFeedback=70 rightFeedback=70" \
+                      "leftFeedback=100 rightFeedback=100 leftDryWet=100 rightDryWet=100" \
+                      "leftHighPassCutFc=20000 rightHighPassCutFc=20000 leftLowPassCutFc=20 rightLowPassCutFc=20" \
+                      "leftHighPassCutFc=20 rightHighPassCutFc=20 leftLowPassCutFc=20000 rightLowPassCutFc=20000"; do
+            args=()
+            for p in $params; do args+=(--param "$p"); done
+            "$render" "$input" /tmp/pgo-train.wav --block 32,512,2048 "${args[@]}" > /dev/null
+        done
+    done
+    rm -f /tmp/pgo-train.wav
+else
+    echo "   (DelayRender not built, JUCE not found: training on RenderCorpus only)"
+fi
+
+# Clang writes raw profiles that have to be merged first
+if compgen -G "$profile_dir/*.profraw" > /dev/null; then
+    llvm-profdata merge -o "$profile_dir/default.profdata" "$profile_dir"/*.profraw
+fi
+
+echo "== optimized build (pgo-use)"
+build pgo-use
+
+echo "== timing RenderCorpus (best of $runs)"
+# alternate the two builds so drift in machine load hits both
+base=1e30
+pgo=1e30
+for i in 1 2 3; do
+    base=$(echo "$base $(corpus_ns build/native-lto)" | awk '{ print ($2 < $1) ? $2 : $1 }')
+    pgo=$(echo "$pgo $(corpus_ns build/pgo)" | awk '{ print ($2 < $1) ? $2 : $1 }')
+done
+
+echo "$base $pgo" | awk '{ printf "native-lto: %.3f ns/sample\npgo:        %.3f ns/sample\nspeedup:    %.3fx\n", $1, $2, $1/$2 }'
@@ -0,0 +1,70 @@
+# Optimization settings shared by the DSP library and everything built on it.
+#
+#   DELAY_ARCH          -march value for the DSP code, e.g. native or x86-64-v3
+#                       (empty: the compiler's default target)
+#   DELAY_LTO           link-time optimization for every target
+#   DELAY_PGO           OFF, GENERATE (instrument for training runs) or USE
+#                       (rebuild with the collected profile)
+#   DELAY_PGO_DIR       where GENERATE writes the profile and USE reads it
+#
+# GCC keys the profile by object file path, so GENERATE and USE have to be
+# configured in the same build directory (the pgo-generate and pgo-use
+# presets share one).
+#
+# Optimized configurations (Release, RelWithDebInfo) always build the DSP
+# code at -O3.
+
+set(DELAY_ARCH "" CACHE STRING "-march value for the DSP code (e.g. native, x86-64-v3)")
+option(DELAY_LTO "Build with link-time optimization" OFF)
+set(DELAY_PGO "OFF" CACHE STRING "Profile-guided optimization stage: OFF, GENERATE or USE")
+set_property(CACHE DELAY_PGO PROPERTY STRINGS OFF GENERATE USE)
+set(DELAY_PGO_DIR "${CMAKE_BINARY_DIR}/pgo-profile" CACHE PATH "Profile directory for DELAY_PGO")
+
+if(DELAY_LTO)
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT delay_lto_supported OUTPUT delay_lto_error LANGUAGES CXX)
+    if(NOT delay_lto_supported)
+        message(FATAL_ERROR "DELAY_LTO is on, but the compiler can't do LTO: ${delay_lto_error}")
+    endif()
+    # every target, so the DSP library can be inlined into the binaries that use it
+    set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
+endif()
+
+if(NOT DELAY_PGO MATCHES "^(OFF|GENERATE|USE)$")
+    message(FATAL_ERROR "DELAY_PGO must be OFF, GENERATE or USE, not ${DELAY_PGO}")
+endif()
+if(NOT DELAY_PGO STREQUAL "OFF" AND MSVC)
+    message(FATAL_ERROR "DELAY_PGO is only supported with GCC and Clang")
+endif()
+
+# Applies the settings above to one target. Compile flags go on the target
+# itself; the PGO link flags are needed by every binary that links
+# instrumented code, so those are passed on through INTERFACE as well.
+function(delay_optimize target)
+    if(NOT MSVC)
+        target_compile_options(${target} PRIVATE $<$<CONFIG:Release,RelWithDebInfo>:-O3>)
+        if(DELAY_ARCH)
+            target_compile_options(${target} PRIVATE -march=${DELAY_ARCH})
+        endif()
+    endif()
+
+    if(DELAY_PGO STREQUAL "GENERATE")
+        if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+            set(flags "-fprofile-generate=${DELAY_PGO_DIR}")
+        else()
+            set(flags "-fprofile-generate" "-fprofile-dir=${DELAY_PGO_DIR}")
+        endif()
+        target_compile_options(${target} PRIVATE ${flags})
+        target_link_options(${target} PUBLIC ${flags})
+    elseif(DELAY_PGO STREQUAL "USE")
+        if(CMAKE_CXX_COMPILER_ID MATCHES "Clang")
+            # Clang writes raw profiles, merge them with llvm-profdata into default.profdata
+            set(flags "-fprofile-use=${DELAY_PGO_DIR}/default.profdata" "-Wno-profile-instr-unprofiled")
+        else()
+            set(flags "-fprofile-use" "-fprofile-dir=${DELAY_PGO_DIR}" "-fprofile-correction"
+                      "-Wno-missing-profile")
+        endif()
+        target_compile_options(${target} PRIVATE ${flags})
+        target_link_options(${target} PUBLIC ${flags})
+    endif()
+endfunction()